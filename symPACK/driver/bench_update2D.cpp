@@ -0,0 +1,141 @@
+/******* Micro benchmark of the 2D cell update kernels ********
+ * Compares, for a range of supernode sizes, the existing non in-place
+ * update path (blas::Gemm into a temporary buffer followed by the scatter)
+ * with the fused GEMM + scatter kernel of sympack/update_kernels.hpp.
+ *
+ * With -narrow, times instead the width specialized POTRF / TRSM / update
+ * kernels against BLAS for widths 1 to 16 and reports the crossover widths.
+ *
+ * usage: bench_update2D [-r repetitions] [-sparse] [-narrow]
+ *   -sparse : updated columns are not contiguous in the target
+ *   -narrow : narrow kernels against BLAS
+ ***************************************************************/
+#include <mpi.h>
+
+#include "sympack.hpp"
+#include "sympack/blas.hpp"
+#include "sympack/update_kernels.hpp"
+
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <cmath>
+
+/******* TYPE used in the computations ********/
+#define SCALAR double
+
+using namespace symPACK;
+
+template <typename T>
+struct update_case_t {
+  Int m, n, k, ldt;
+  std::vector<T> facing, pivot, tgt;
+  std::vector<Int> row_offset, col_offset;
+
+  update_case_t(Int pm, Int pn, Int pk, bool sparse):m(pm),n(pn),k(pk) {
+    std::mt19937 gen(m*131+n*7+k);
+    std::uniform_real_distribution<double> dist(-1.0,1.0);
+    //the target cell is wider than the update and has extra rows
+    ldt = sparse ? 2*n : n + 8;
+    facing.resize(m*k);
+    pivot.resize(n*k);
+    tgt.resize(2*m*ldt);
+    for (auto & v: facing) v = T(dist(gen));
+    for (auto & v: pivot) v = T(dist(gen));
+    for (auto & v: tgt) v = T(dist(gen));
+    row_offset.resize(m);
+    col_offset.resize(n);
+    for (Int i = 0; i < m; ++i) row_offset[i] = (2*i+(i%3==0))*ldt;
+    for (Int j = 0; j < n; ++j) col_offset[j] = sparse ? 2*j : 4+j;
+  }
+};
+
+//existing path: GEMM into a buffer then scatter
+template <typename T>
+void reference_update( update_case_t<T> & c, std::vector<T> & buf, bool sparse ) {
+  buf.resize(c.m*c.n);
+  blas::Gemm('T','N',c.n,c.m,c.k,T(-1.0),c.pivot.data(),c.k,c.facing.data(),c.k,T(0),buf.data(),c.n);
+  T * tgt = c.tgt.data();
+  if ( !sparse ) {
+    for (Int i = 0; i < c.m; ++i) {
+      blas::Axpy(c.n, T(1.0), &buf[i*c.n], 1, &tgt[c.row_offset[i] + c.col_offset[0]], 1);
+    }
+  }
+  else {
+    for (Int i = 0; i < c.m; ++i) {
+      for (Int j = 0; j < c.n; ++j) {
+        tgt[c.row_offset[i] + c.col_offset[j]] += buf[i*c.n+j];
+      }
+    }
+  }
+}
+
+//fused path: pack the pivot then accumulate straight into the target
+template <typename T>
+void fused_update( update_case_t<T> & c, std::vector<T> & buf ) {
+  buf.resize(c.n*c.k);
+  kernels::pack_transpose(c.n,c.k,c.pivot.data(),c.k,buf.data());
+  kernels::gemm_scatter(c.m,c.n,c.k,(const T*)c.facing.data(),c.k,(const T*)buf.data(),c.n,
+      c.tgt.data(),c.row_offset.data(),c.col_offset.data());
+}
+
+int main(int argc, char **argv)
+{
+  int success = symPACK_Init(&argc,&argv);
+  if (success==-1)
+    return 1;
+  {
+    int reps = 50;
+    bool sparse = false;
+    bool narrow = false;
+    for (int i = 1; i < argc; i++) {
+      if ( !strcmp(argv[i],"-r") && i+1<argc ) { reps = atoi(argv[++i]); }
+      else if ( !strcmp(argv[i],"-sparse") ) { sparse = true; }
+      else if ( !strcmp(argv[i],"-narrow") ) { narrow = true; }
+    }
+
+    if (upcxx::rank_me()==0 && narrow) {
+      auto limits = kernels::calibrate_narrow<SCALAR>(&std::cout,reps);
+      std::cout<<"crossover widths: potrf "<<limits.potrf<<", trsm "<<limits.trsm<<", update "<<limits.update<<std::endl;
+    }
+    else if (upcxx::rank_me()==0) {
+      std::cout<<std::setw(6)<<"m"<<std::setw(6)<<"n"<<std::setw(6)<<"k"
+        <<std::setw(14)<<"gemm+add (us)"<<std::setw(14)<<"fused (us)"<<std::setw(10)<<"speedup"
+        <<std::setw(8)<<"limit"<<std::setw(12)<<"max err"<<std::endl;
+
+      std::vector<SCALAR> buf;
+      for (Int k: {1, 2, 4, 8, 16, 32, 64}) {
+        for (Int n: {4, 16, 64, 128}) {
+          for (Int m: {16, 64, 256}) {
+            update_case_t<SCALAR> ref(m,n,k,sparse);
+            update_case_t<SCALAR> fus(m,n,k,sparse);
+
+            auto t1 = std::chrono::high_resolution_clock::now();
+            for (int r = 0; r < reps; r++) { reference_update(ref,buf,sparse); }
+            auto t2 = std::chrono::high_resolution_clock::now();
+            for (int r = 0; r < reps; r++) { fused_update(fus,buf); }
+            auto t3 = std::chrono::high_resolution_clock::now();
+
+            double ref_us = std::chrono::duration<double,std::micro>(t2-t1).count()/reps;
+            double fus_us = std::chrono::duration<double,std::micro>(t3-t2).count()/reps;
+
+            double err = 0;
+            for (size_t i = 0; i < ref.tgt.size(); i++) {
+              err = std::max(err,(double)std::abs(ref.tgt[i]-fus.tgt[i]));
+            }
+
+            std::cout<<std::setw(6)<<m<<std::setw(6)<<n<<std::setw(6)<<k
+              <<std::setw(14)<<ref_us<<std::setw(14)<<fus_us<<std::setw(10)<<ref_us/fus_us
+              <<std::setw(8)<<(kernels::use_fused_update<SCALAR>(m,n,k)?"fused":"blas")
+              <<std::setw(12)<<err<<std::endl;
+          }
+        }
+      }
+    }
+  }
+  upcxx::barrier();
+  symPACK_Finalize();
+  return 0;
+}
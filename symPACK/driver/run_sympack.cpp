@@ -49,7 +49,18 @@ int main(int argc, char **argv)
     std::string informatstr;
     bool complextype=false;
     int nrhs = 0;
-    process_options(argc, argv, optionsFact, filename, informatstr, complextype, nrhs);
+    int nrefact = 0;
+    process_options(argc, argv, optionsFact, filename, informatstr, complextype, nrhs, nrefact);
+    //symPACKMatrix cannot refactorize
+    if (nrefact > 0) {
+      if (iam==0) {
+        std::cerr<<"-refact is only supported by run_sympack2D"<<std::endl;
+      }
+      MPI_Comm_free(&worldcomm);
+      delete logfileptr;
+      symPACK_Finalize();
+      return 1;
+    }
     //-----------------------------------------------------------------
 
     Real timeSta, timeEnd;
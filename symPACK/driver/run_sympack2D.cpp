@@ -45,7 +45,8 @@ int main(int argc, char **argv)
     std::string informatstr;
     bool complextype=false;
     int nrhs = 0;
-    process_options(argc, argv, optionsFact, filename, informatstr, complextype, nrhs);
+    int nrefact = 0;
+    process_options(argc, argv, optionsFact, filename, informatstr, complextype, nrhs, nrefact);
     //-----------------------------------------------------------------
 
     Real timeSta, timeEnd;
@@ -97,6 +98,16 @@ int main(int argc, char **argv)
         std::cout<<"Factorization time: "<<timeEnd-timeSta<<" seconds"<<std::endl;
       }
       logfileptr->OFS()<<"Factorization time: "<<timeEnd-timeSta<<" seconds"<<std::endl;
+
+      for (int r = 0; r < nrefact; r++) {
+        timeSta = get_time();
+        SMat2D->Refactorize(HMat);
+        timeEnd = get_time();
+        if(iam==0){
+          std::cout<<"Refactorization time: "<<timeEnd-timeSta<<" seconds"<<std::endl;
+        }
+        logfileptr->OFS()<<"Refactorization time: "<<timeEnd-timeSta<<" seconds"<<std::endl;
+      }
     }
     catch(const std::bad_alloc& e){
       std::cout << "Allocation failed: " << e.what() << '\n';
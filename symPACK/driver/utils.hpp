@@ -224,7 +224,7 @@ inline size_t parse_size(const char *desc, const std::vector<std::string> &args,
     return sz;
 }
 
-inline void process_options(int argc, char **argv, symPACK::symPACKOptions & optionsFact,std::string & filename, std::string & informatstr, bool & complextype, int & nrhs){
+inline void process_options(int argc, char **argv, symPACK::symPACKOptions & optionsFact,std::string & filename, std::string & informatstr, bool & complextype, int & nrhs, int & nrefact){
   using namespace symPACK;
   using option_t = std::map<std::string,std::vector<std::string> > ;
   // *********************************************************************
@@ -309,6 +309,118 @@ inline void process_options(int argc, char **argv, symPACK::symPACKOptions & opt
     optionsFact.memory_limit = atof(options["-mem"].front().c_str()) ;
   }
 
+  optionsFact.reuse_update_maps=false;
+  if (options.find("-reuse_maps") != options.end()){
+    optionsFact.reuse_update_maps = atoi(options["-reuse_maps"].front().c_str()) == 1;
+  }
+
+  optionsFact.cell_arena=true;
+  if (options.find("-arena") != options.end()){
+    optionsFact.cell_arena = atoi(options["-arena"].front().c_str()) == 1;
+  }
+
+  optionsFact.landing_zone_pool = 64<<20;
+  if (options.find("-lz_pool") != options.end()){
+    optionsFact.landing_zone_pool = parse_size("-lz_pool", options["-lz_pool"]);
+  }
+
+  optionsFact.local_views=true;
+  if (options.find("-local_views") != options.end()){
+    optionsFact.local_views = atoi(options["-local_views"].front().c_str()) == 1;
+  }
+
+  optionsFact.eager_limit = 4096;
+  if (options.find("-eager_limit") != options.end()){
+    optionsFact.eager_limit = parse_size("-eager_limit", options["-eager_limit"]);
+  }
+
+  optionsFact.aggregate_bytes = 16384;
+  if (options.find("-aggregate") != options.end()){
+    optionsFact.aggregate_bytes = parse_size("-aggregate", options["-aggregate"]);
+  }
+
+  optionsFact.aggregate_ticks = 8;
+  if (options.find("-aggregate_ticks") != options.end()){
+    optionsFact.aggregate_ticks = atoi(options["-aggregate_ticks"].front().c_str());
+  }
+
+  optionsFact.task_priority = TaskPriorityType::LEXICOGRAPHIC;
+  if (options.find("-priority") != options.end()){
+    std::string priority = options["-priority"].front();
+    if (priority.compare("lex")==0) {
+      //do nothing, since this is the default option
+    } else if (priority.compare("bottom_level")==0) {
+      optionsFact.task_priority = TaskPriorityType::BOTTOM_LEVEL;
+    } else {
+      throw std::invalid_argument("Error: " + priority + " is not a valid priority option. Use 'lex' or 'bottom_level' instead.");
+    }
+  }
+
+  optionsFact.pin_threads=false;
+  if (options.find("-pin_threads") != options.end()){
+    optionsFact.pin_threads = atoi(options["-pin_threads"].front().c_str()) == 1;
+  }
+
+  optionsFact.progress_thread=false;
+  if (options.find("-progress_thread") != options.end()){
+    optionsFact.progress_thread = atoi(options["-progress_thread"].front().c_str()) == 1;
+  }
+
+  optionsFact.idle_backoff=false;
+  if (options.find("-idle_backoff") != options.end()){
+    optionsFact.idle_backoff = atoi(options["-idle_backoff"].front().c_str()) == 1;
+  }
+
+  optionsFact.subtree_fast_path=false;
+  if (options.find("-subtree_fast_path") != options.end()){
+    optionsFact.subtree_fast_path = atoi(options["-subtree_fast_path"].front().c_str()) == 1;
+  }
+
+  optionsFact.hybrid_depth=-1;
+  if (options.find("-hybrid_depth") != options.end()){
+    optionsFact.hybrid_depth = atoi(options["-hybrid_depth"].front().c_str());
+  }
+
+  optionsFact.hybrid_width=0;
+  if (options.find("-hybrid_width") != options.end()){
+    optionsFact.hybrid_width = atoi(options["-hybrid_width"].front().c_str());
+  }
+
+  optionsFact.tile_width=0;
+  if (options.find("-tile") != options.end()){
+    optionsFact.tile_width = atoi(options["-tile"].front().c_str());
+  }
+
+  optionsFact.nested_flops=0.0;
+  if (options.find("-nested_flops") != options.end()){
+    optionsFact.nested_flops = atof(options["-nested_flops"].front().c_str());
+  }
+
+  optionsFact.dense_root=0;
+  if (options.find("-dense_root") != options.end()){
+    optionsFact.dense_root = atoi(options["-dense_root"].front().c_str());
+  }
+
+  optionsFact.dense_tile=128;
+  if (options.find("-dense_tile") != options.end()){
+    optionsFact.dense_tile = atoi(options["-dense_tile"].front().c_str());
+  }
+
+  optionsFact.batch_width=0;
+  if (options.find("-batch_width") != options.end()){
+    optionsFact.batch_width = atoi(options["-batch_width"].front().c_str());
+  }
+
+  optionsFact.batch_size=32;
+  if (options.find("-batch_size") != options.end()){
+    optionsFact.batch_size = atoi(options["-batch_size"].front().c_str());
+  }
+
+  optionsFact.narrow_kernels=0;
+  if (options.find("-narrow") != options.end()){
+    optionsFact.narrow_kernels = atoi(options["-narrow"].front().c_str());
+  }
+
   optionsFact.print_stats=false;
   if (options.find("-ps") != options.end()){
     optionsFact.print_stats = atoi(options["-ps"].front().c_str()) == 1;
@@ -442,6 +554,12 @@ inline void process_options(int argc, char **argv, symPACK::symPACKOptions & opt
     nrhs= atoi(options["-nrhs"].front().c_str());
   }
 
+  //number of additional numeric factorizations reusing the symbolic structure
+  nrefact = 0;
+  if( options.find("-refact") != options.end() ){
+    nrefact= atoi(options["-refact"].front().c_str());
+  }
+
   //-----------------------------------------------------------------
   optionsFact.maxIsend = maxIsend;
   optionsFact.maxIrecv = maxIrecv;
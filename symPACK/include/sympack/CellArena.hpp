@@ -0,0 +1,126 @@
+#ifndef _SYMPACK_CELL_ARENA_HPP_
+#define _SYMPACK_CELL_ARENA_HPP_
+
+#include <upcxx/upcxx.hpp>
+
+#include <vector>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <algorithm>
+
+namespace symPACK {
+
+  //Bump allocator handing out 64-byte aligned cell storage from a few large
+  //regions of the UPC++ shared segment. Storage is never freed individually:
+  //all the regions are released at once by release() or by the destructor.
+  class cell_arena_t {
+    public:
+      static const size_t alignment = 64;
+
+      cell_arena_t():chunk_size_(0),capacity_(0),used_(0),requested_(0),allocations_(0),fallbacks_(0) {}
+      ~cell_arena_t() { release(); }
+
+      cell_arena_t( const cell_arena_t & ) = delete;
+      cell_arena_t & operator=( const cell_arena_t & ) = delete;
+
+      static size_t padded( size_t bytes ) {
+        return (bytes + alignment - 1) / alignment * alignment;
+      }
+
+      //reserves a first region of bytes, further regions of at least
+      //chunk_size bytes are added when it is full (no growth if 0)
+      void reserve( size_t bytes, size_t chunk_size = 0 ) {
+        std::lock_guard<std::mutex> lock(lock_);
+        chunk_size_ = chunk_size;
+        if ( bytes > 0 ) add_region_( padded(bytes) );
+      }
+
+      //returns a null pointer if the request cannot be served,
+      //the caller is expected to fall back to upcxx::allocate
+      upcxx::global_ptr<char> allocate( size_t bytes ) {
+        size_t size = padded(std::max(bytes,(size_t)1));
+        std::lock_guard<std::mutex> lock(lock_);
+        if ( regions_.empty() || regions_.back().head + size > regions_.back().size ) {
+          if ( chunk_size_ == 0 || !add_region_( std::max(size,padded(chunk_size_)) ) ) {
+            fallbacks_++;
+            return nullptr;
+          }
+        }
+        auto & region = regions_.back();
+        auto ptr = region.base + region.head;
+        region.head += size;
+        used_ += size;
+        requested_ += bytes;
+        allocations_++;
+        return ptr;
+      }
+
+      //rewinds the arena, all the storage handed out so far becomes invalid
+      void clear() {
+        std::lock_guard<std::mutex> lock(lock_);
+        for ( auto & region: regions_ ) { region.head = 0; }
+        if ( regions_.size() > 1 ) {
+          //keep a single region large enough for what was used
+          size_t total = capacity_;
+          for ( auto & region: regions_ ) { upcxx::deallocate(region.base); }
+          regions_.clear();
+          capacity_ = 0;
+          add_region_(total);
+        }
+        used_ = 0;
+        requested_ = 0;
+        allocations_ = 0;
+        fallbacks_ = 0;
+      }
+
+      void release() {
+        std::lock_guard<std::mutex> lock(lock_);
+        for ( auto & region: regions_ ) { upcxx::deallocate(region.base); }
+        regions_.clear();
+        capacity_ = 0;
+        used_ = 0;
+      }
+
+      size_t capacity() const { return capacity_; }
+      size_t used() const { return used_; }
+      size_t requested() const { return requested_; }
+      size_t allocations() const { return allocations_; }
+      size_t fallbacks() const { return fallbacks_; }
+      size_t regions() const { return regions_.size(); }
+      double utilization() const { return capacity_ > 0 ? (double)requested_ / (double)capacity_ : 0.0; }
+
+      void print_stats( std::ostream & os, const std::string & name ) const {
+        os<<name<<": "<<regions_.size()<<" regions, capacity "<<capacity_<<" bytes, used "<<used_
+          <<" bytes, requested "<<requested_<<" bytes ("<<utilization()*100.0<<"%), "
+          <<allocations_<<" allocations, "<<fallbacks_<<" fallbacks"<<std::endl;
+      }
+
+    protected:
+      struct region_t {
+        upcxx::global_ptr<char> base;
+        size_t size;
+        size_t head;
+      };
+
+      bool add_region_( size_t bytes ) {
+        auto base = upcxx::allocate<char>(bytes,alignment);
+        if ( base.is_null() ) return false;
+        regions_.push_back(region_t{base,bytes,0});
+        capacity_ += bytes;
+        return true;
+      }
+
+      std::vector<region_t> regions_;
+      std::mutex lock_;
+      size_t chunk_size_;
+      size_t capacity_;
+      size_t used_;
+      size_t requested_;
+      size_t allocations_;
+      size_t fallbacks_;
+  };
+
+} // namespace symPACK
+
+#endif // _SYMPACK_CELL_ARENA_HPP_
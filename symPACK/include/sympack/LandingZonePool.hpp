@@ -0,0 +1,147 @@
+#ifndef _SYMPACK_LANDING_ZONE_POOL_HPP_
+#define _SYMPACK_LANDING_ZONE_POOL_HPP_
+
+#include <upcxx/upcxx.hpp>
+
+#include <vector>
+#include <mutex>
+#include <ostream>
+#include <algorithm>
+
+namespace symPACK {
+
+  //Pool of landing zones for the remote cells fetched by the 2D scheduler.
+  //Buffers are taken from the shared segment when possible (so they are
+  //registered targets for upcxx::rget) and recycled by size class. Classes
+  //are spaced by a quarter of a power of two, so at most 25% is wasted.
+  //At most capacity() bytes are kept in the free lists.
+  class landing_zone_pool_t {
+    public:
+      static const int min_shift = 8;
+      static const int sub_classes = 4;
+
+      landing_zone_pool_t():capacity_(0),cached_bytes_(0),peak_cached_bytes_(0),
+        hits_(0),misses_(0),evictions_(0) {}
+      ~landing_zone_pool_t() { clear(); }
+
+      landing_zone_pool_t( const landing_zone_pool_t & ) = delete;
+      landing_zone_pool_t & operator=( const landing_zone_pool_t & ) = delete;
+
+      static int size_class( size_t bytes ) {
+        if ( bytes <= ((size_t)1<<min_shift) ) return 0;
+        int k = 63 - __builtin_clzll( (unsigned long long)(bytes-1) );
+        size_t quarter = (size_t)1<<(k-2);
+        int m = (int)( (bytes - ((size_t)1<<k) + quarter - 1) / quarter );
+        return (k-min_shift)*sub_classes + m;
+      }
+
+      static size_t class_size( int c ) {
+        int k = c / sub_classes + min_shift;
+        int m = c % sub_classes;
+        return ((size_t)1<<k) + m*((size_t)1<<(k-2));
+      }
+
+      //maximum number of bytes kept in the free lists, 0 disables the pool
+      void set_capacity( size_t bytes ) {
+        std::lock_guard<std::mutex> lock(lock_);
+        capacity_ = bytes;
+        trim_();
+      }
+
+      char * allocate( size_t bytes ) {
+        int c = size_class(bytes);
+        {
+          std::lock_guard<std::mutex> lock(lock_);
+          if ( c < (int)free_lists_.size() && !free_lists_[c].empty() ) {
+            char * ptr = free_lists_[c].back();
+            free_lists_[c].pop_back();
+            cached_bytes_ -= class_size(c);
+            hits_++;
+            return ptr;
+          }
+          misses_++;
+        }
+        size_t size = class_size(c);
+        char * ptr = upcxx::allocate<char>(size,64).local();
+        if ( ptr == nullptr ) ptr = new char[size];
+        return ptr;
+      }
+
+      //bytes is the size given to allocate
+      void release( char * ptr, size_t bytes ) {
+        int c = size_class(bytes);
+        size_t size = class_size(c);
+        {
+          std::lock_guard<std::mutex> lock(lock_);
+          if ( cached_bytes_ + size <= capacity_ ) {
+            if ( c >= (int)free_lists_.size() ) free_lists_.resize(c+1);
+            free_lists_[c].push_back(ptr);
+            cached_bytes_ += size;
+            peak_cached_bytes_ = std::max(peak_cached_bytes_,cached_bytes_);
+            return;
+          }
+          evictions_++;
+        }
+        free_(ptr);
+      }
+
+      //frees all the cached buffers
+      void clear() {
+        std::lock_guard<std::mutex> lock(lock_);
+        for ( auto & list: free_lists_ ) {
+          for ( auto ptr: list ) { free_(ptr); }
+          list.clear();
+        }
+        cached_bytes_ = 0;
+      }
+
+      size_t capacity() const { return capacity_; }
+      size_t cached_bytes() const { return cached_bytes_; }
+      size_t hits() const { return hits_; }
+      size_t misses() const { return misses_; }
+      size_t evictions() const { return evictions_; }
+
+      void print_stats( std::ostream & os ) const {
+        size_t requests = hits_ + misses_;
+        os<<"Landing zone pool: "<<hits_<<" hits, "<<misses_<<" misses ("
+          <<(requests>0?100.0*hits_/requests:0.0)<<"% hit rate), "<<evictions_<<" evictions, cached "
+          <<cached_bytes_<<" bytes (peak "<<peak_cached_bytes_<<", capacity "<<capacity_<<")"<<std::endl;
+      }
+
+    protected:
+      static void free_( char * ptr ) {
+        auto gptr = upcxx::try_global_ptr(ptr);
+        if ( !gptr.is_null() ) {
+          upcxx::deallocate(gptr);
+        }
+        else {
+          delete [] ptr;
+        }
+      }
+
+      //drops cached buffers, largest classes first, until the capacity is honored
+      void trim_() {
+        for ( int c = (int)free_lists_.size()-1; c >= 0 && cached_bytes_ > capacity_; c-- ) {
+          auto & list = free_lists_[c];
+          while ( !list.empty() && cached_bytes_ > capacity_ ) {
+            free_(list.back());
+            list.pop_back();
+            cached_bytes_ -= class_size(c);
+            evictions_++;
+          }
+        }
+      }
+
+      std::vector< std::vector<char*> > free_lists_;
+      std::mutex lock_;
+      size_t capacity_;
+      size_t cached_bytes_;
+      size_t peak_cached_bytes_;
+      size_t hits_;
+      size_t misses_;
+      size_t evictions_;
+  };
+
+} // namespace symPACK
+
+#endif // _SYMPACK_LANDING_ZONE_POOL_HPP_
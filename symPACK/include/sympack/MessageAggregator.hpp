@@ -0,0 +1,125 @@
+#ifndef _SYMPACK_MESSAGE_AGGREGATOR_HPP_
+#define _SYMPACK_MESSAGE_AGGREGATOR_HPP_
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <functional>
+
+namespace symPACK {
+
+  //Per-destination buffers of outgoing records. A buffer is handed to the
+  //send function once it holds flush_bytes bytes, or by tick() after
+  //flush_ticks calls or when the caller runs out of work. Records are sent
+  //right away if flush_bytes is 0.
+  template <typename record_t>
+    class message_aggregator_t {
+      public:
+        using send_t = std::function<void(int dest, std::vector<record_t> & records)>;
+
+        message_aggregator_t():flush_bytes_(0),flush_ticks_(0),ticks_(0),pending_(0),
+          records_(0),batches_(0),bytes_sent_(0) {}
+
+        message_aggregator_t( const message_aggregator_t & ) = delete;
+        message_aggregator_t & operator=( const message_aggregator_t & ) = delete;
+
+        void init( int nranks, send_t send, size_t flush_bytes, int flush_ticks ) {
+          std::lock_guard<std::mutex> lock(lock_);
+          buffers_.assign(nranks,buffer_t());
+          send_ = send;
+          flush_bytes_ = flush_bytes;
+          flush_ticks_ = flush_ticks;
+          ticks_ = 0;
+          pending_ = 0;
+        }
+
+        //bytes is the approximate serialized size of the record
+        void post( int dest, record_t && record, size_t bytes ) {
+          std::vector<record_t> batch;
+          {
+            std::lock_guard<std::mutex> lock(lock_);
+            auto & buffer = buffers_[dest];
+            buffer.records.push_back(std::move(record));
+            buffer.bytes += bytes;
+            records_++;
+            pending_++;
+            if ( buffer.bytes >= flush_bytes_ ) {
+              pending_ -= buffer.records.size();
+              take_(buffer,batch);
+            }
+          }
+          if ( !batch.empty() ) send_(dest,batch);
+        }
+
+        //called once per round of the progress loop, by a single thread
+        void tick( bool flush_all ) {
+          if ( pending_.load(std::memory_order_relaxed) == 0 ) return;
+          if ( flush_all || ++ticks_ >= flush_ticks_ ) {
+            ticks_ = 0;
+            flush();
+          }
+        }
+
+        void flush() {
+          std::vector< std::pair<int,std::vector<record_t> > > batches;
+          {
+            std::lock_guard<std::mutex> lock(lock_);
+            for ( int dest = 0; dest < (int)buffers_.size(); dest++ ) {
+              auto & buffer = buffers_[dest];
+              if ( buffer.records.empty() ) continue;
+              pending_ -= buffer.records.size();
+              batches.emplace_back(dest,std::vector<record_t>());
+              take_(buffer,batches.back().second);
+            }
+          }
+          for ( auto & batch: batches ) send_(batch.first,batch.second);
+        }
+
+        //clears the counters printed by print_stats, e.g. before a new factorization
+        void reset_stats() {
+          std::lock_guard<std::mutex> lock(lock_);
+          records_ = 0;
+          batches_ = 0;
+          bytes_sent_ = 0;
+        }
+
+        size_t records() const { return records_; }
+        size_t batches() const { return batches_; }
+
+        void print_stats( std::ostream & os, const std::string & name ) const {
+          os<<name<<": "<<records_<<" records in "<<batches_<<" messages ("
+            <<(batches_>0?(double)records_/batches_:0.0)<<" per message, "<<bytes_sent_<<" bytes)"<<std::endl;
+        }
+
+      protected:
+        struct buffer_t {
+          std::vector<record_t> records;
+          size_t bytes;
+          buffer_t():bytes(0) {}
+        };
+
+        //must be called with the lock held
+        void take_( buffer_t & buffer, std::vector<record_t> & batch ) {
+          batch.swap(buffer.records);
+          bytes_sent_ += buffer.bytes;
+          buffer.bytes = 0;
+          batches_++;
+        }
+
+        std::vector<buffer_t> buffers_;
+        send_t send_;
+        std::mutex lock_;
+        size_t flush_bytes_;
+        int flush_ticks_;
+        int ticks_;
+        std::atomic<size_t> pending_;
+        size_t records_;
+        size_t batches_;
+        size_t bytes_sent_;
+    };
+
+} // namespace symPACK
+
+#endif // _SYMPACK_MESSAGE_AGGREGATOR_HPP_
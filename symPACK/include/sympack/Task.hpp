@@ -13,7 +13,7 @@ namespace symPACK{
 
 
 namespace Factorization{
-  enum class op_type {UPDATE,AGGREGATE,FACTOR,TRSM,COMM,TRSM_SEND,UPDATE2D_COMP,UPDATE2D_SEND,AGGREGATE2D_SEND,TRSM_RECV,UPDATE2D_RECV,AGGREGATE2D_RECV,UPDATE2D_SEND_OD,UPDATE2D_RECV_OD,DIAG_ENTRIES,UPDATE2D_DIAG_RECV,UPDATE2D_DIAG_SEND,FUC,BUC,FUC_D_SEND,FUC_D_RECV,FUC_DIAG_SEND,FUC_DIAG_RECV,FUC_SEND,FUC_RECV,BUC_D_SEND,BUC_D_RECV,BUC_SEND,BUC_RECV,DLT2D_COMP};
+  enum class op_type {UPDATE,AGGREGATE,FACTOR,TRSM,COMM,TRSM_SEND,UPDATE2D_COMP,UPDATE2D_SEND,AGGREGATE2D_SEND,TRSM_RECV,UPDATE2D_RECV,AGGREGATE2D_RECV,UPDATE2D_SEND_OD,UPDATE2D_RECV_OD,DIAG_ENTRIES,UPDATE2D_DIAG_RECV,UPDATE2D_DIAG_SEND,FUC,BUC,FUC_D_SEND,FUC_D_RECV,FUC_DIAG_SEND,FUC_DIAG_RECV,FUC_SEND,FUC_RECV,BUC_D_SEND,BUC_D_RECV,BUC_SEND,BUC_RECV,DLT2D_COMP,SUBTREE2D};
 }
 
 namespace Solve{
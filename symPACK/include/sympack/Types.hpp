@@ -95,6 +95,8 @@ namespace symPACK{
   };
 
   enum class DecompositionType {LL,LDL};
+  //order of the ready and available tasks of the 2D scheduler
+  enum class TaskPriorityType {LEXICOGRAPHIC,BOTTOM_LEVEL};
 
   enum MappingType {ROW2D,COL2D,MODWRAP2D,MODWRAP2DNS,WRAP2D,WRAP2DFORCED};
   enum FactorizationType {FANOUT,FANBOTH,FANBOTH_STATIC};
@@ -135,7 +137,53 @@ namespace symPACK{
       int verbose;
       int dumpPerm;
       int * perm;
+      //budget in bytes of the remote cells fetched by the 2D scheduler, unlimited if not positive
       double memory_limit;
+      //cache the relative indices of 2D updates across factorizations
+      bool reuse_update_maps;
+      //carve the 2D cells out of a per-rank arena of the shared segment
+      bool cell_arena;
+      //bytes of free landing zones kept for reuse by the 2D scheduler, 0 disables the pool
+      size_t landing_zone_pool;
+      //read the cells produced by ranks of the same node in place
+      bool local_views;
+      //cells of at most this many bytes are sent inside the notifying rpc, 0 disables it
+      size_t eager_limit;
+      //cell notifications to a rank are batched until they reach this many bytes, 0 disables it
+      size_t aggregate_bytes;
+      //rounds of the scheduling loop after which batched notifications are sent anyway
+      int aggregate_ticks;
+      TaskPriorityType task_priority;
+      //bind the worker threads of the 2D scheduler to distinct cpus
+      bool pin_threads;
+      //with a single thread per rank, compute on a worker while the main thread
+      //keeps making UPC++ progress (requires SP_THREADS)
+      bool progress_thread;
+      //idle 2D scheduling loops and workers sleep after a short spin instead of busy waiting
+      bool idle_backoff;
+      //factor each small leaf subtree owned by a single rank as one left-looking 2D task (Cholesky only)
+      bool subtree_fast_path;
+      //2D supernodes at this etree depth or below (root is 0) are mapped to a single rank, -1 disables it
+      Int hybrid_depth;
+      //2D supernodes of at most this many columns are mapped to a single rank
+      Int hybrid_width;
+      //2D supernodes wider than this are cut in tiles of at most this many columns, 0 disables it
+      Int tile_width;
+      //2D kernels of at least this many flops are tiled across the idle workers (requires SP_THREADS), 0 disables it
+      double nested_flops;
+      //2D supernodes of at least this many columns, like all their ancestors, are factored as one dense
+      //block cyclic matrix with bottom level task priorities, 0 disables it
+      Int dense_root;
+      //width of the tiles of the dense supernodes
+      Int dense_tile;
+      //ready 2D tasks of the same kind on supernodes of at most batch_width columns (16 at
+      //most) are grouped and run in a single call with the narrow kernels, batch_size at
+      //most, 0 disables it
+      Int batch_width;
+      Int batch_size;
+      //2D kernels on supernodes of at most this many columns (16 at most) use the width
+      //specialized kernels instead of BLAS, -1 measures the crossover, 0 disables them
+      Int narrow_kernels;
     protected:
       bool isSqrtP(){
         bool val = false;
@@ -185,6 +233,27 @@ namespace symPACK{
         iterRefinement=false;
 
         memory_limit = -1.0;
+        reuse_update_maps = false;
+        cell_arena = true;
+        landing_zone_pool = 64<<20;
+        local_views = true;
+        eager_limit = 4096;
+        aggregate_bytes = 16384;
+        aggregate_ticks = 8;
+        task_priority = TaskPriorityType::LEXICOGRAPHIC;
+        pin_threads = false;
+        progress_thread = false;
+        idle_backoff = false;
+        subtree_fast_path = false;
+        hybrid_depth = -1;
+        hybrid_width = 0;
+        tile_width = 0;
+        nested_flops = 0.0;
+        dense_root = 0;
+        dense_tile = 128;
+        batch_width = 0;
+        batch_size = 32;
+        narrow_kernels = 0;
       }
 
       Int used_procs(Int np){
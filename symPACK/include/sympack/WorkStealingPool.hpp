@@ -0,0 +1,389 @@
+#ifndef _SYMPACK_WORK_STEALING_POOL_HPP_
+#define _SYMPACK_WORK_STEALING_POOL_HPP_
+
+#include <sched.h>
+#include <pthread.h>
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <ostream>
+#include <functional>
+
+#include "sympack/update_kernels.hpp"
+
+namespace symPACK {
+
+  //Worker threads with one task deque each. A worker runs the tasks of its own
+  //deque last in first out, then the tasks submitted by other threads, and
+  //otherwise steals the oldest task of another worker.
+  //Tasks pushed by a worker (e.g. the successors it made ready) go to its own deque.
+  //The workers are created once by start() and stay parked on a condition
+  //variable between two executions (begin() ... end()) until shutdown().
+  //With backoff, a worker finding no task spins for spin_rounds attempts and
+  //then sleeps until a task is pushed (or max_wait at most).
+  //A worker running a large kernel while other workers have no task splits it
+  //in row tiles that the idle workers help with (see kernels::run_tiled).
+  template <typename ttask_t>
+    class work_stealing_pool_t: public kernels::tile_executor_t {
+      public:
+        using run_t = std::function<void(ttask_t *)>;
+
+        static const int spin_rounds = 64;
+        static constexpr std::chrono::microseconds max_wait{1000};
+
+        work_stealing_pool_t():done_(true),shutdown_(false),epoch_(0),finished_(0),
+          active_(0),steals_(0),pinned_(false),backoff_(false),signals_(0),sleepers_(0),
+          nested_(nullptr),nested_helpers_(0),nested_cnt_(0) {}
+        ~work_stealing_pool_t() { shutdown(); }
+
+        work_stealing_pool_t( const work_stealing_pool_t & ) = delete;
+        work_stealing_pool_t & operator=( const work_stealing_pool_t & ) = delete;
+
+        //creates nthreads parked workers, init is called by each of them once.
+        //Nothing is done if the pool already has nthreads workers.
+        //If pin is true, worker k is bound to the k+1-th cpu the process may run on.
+        //When that mask is the whole node, it is shared by the other processes of
+        //the node: the local_rank-th process then uses its own block of nthreads+1 cpus.
+        void start( int nthreads, std::function<void()> init, bool pin = false, int local_rank = 0 ) {
+          if ( (int)threads_.size() == nthreads && pinned_ == pin ) return;
+          shutdown();
+          shutdown_ = false;
+          pinned_ = pin;
+          queues_.clear();
+          for (int count = 0; count < nthreads; count++) { queues_.emplace_back(new queue_t()); }
+          std::vector<int> cpus;
+          int first_cpu = 0;
+          if ( pin ) {
+            cpus = allowed_cpus_();
+            if ( cpus.size() >= std::thread::hardware_concurrency() ) first_cpu = local_rank*(nthreads+1);
+          }
+          threads_.reserve(nthreads);
+          for (int count = 0; count < nthreads; count++) {
+            //the first cpu is left to the calling thread
+            int cpu = cpus.empty() ? -1 : cpus[(first_cpu+count+1)%cpus.size()];
+            threads_.emplace_back([this,init,epoch=epoch_](int id, int cpu) {
+                if ( cpu >= 0 ) {
+                  cpu_set_t set;
+                  CPU_ZERO(&set);
+                  CPU_SET(cpu,&set);
+                  pthread_setaffinity_np(pthread_self(),sizeof(set),&set);
+                }
+                current_ = this;
+                worker_id_ = id;
+                kernels::tile_executor_t::current() = this;
+                if ( init != nullptr ) init();
+                this->work_(id,epoch);
+                kernels::tile_executor_t::current() = nullptr;
+                current_ = nullptr;
+                worker_id_ = -1;
+                }, count, cpu);
+          }
+        }
+
+        void set_backoff( bool backoff ) { backoff_ = backoff; }
+
+        //kernels of at least min_flops are tiled when some workers are idle, 0 disables it
+        void set_nested( double min_flops ) { this->min_flops = min_flops; }
+
+        virtual int concurrency() const override { return threads_.size(); }
+
+        virtual bool parallel_for( int ntiles, const std::function<void(int)> & body ) override {
+          //every worker has a task to run or to steal
+          if ( active_.load(std::memory_order_acquire) >= (int64_t)threads_.size() ) return false;
+          nested_job_t job(body,ntiles);
+          //a single tiled kernel at a time
+          nested_job_t * expected = nullptr;
+          if ( !nested_.compare_exchange_strong(expected,&job) ) return false;
+          signals_++;
+          if ( sleepers_.load() > 0 ) {
+            std::lock_guard<std::mutex> lock(work_lock_);
+            work_cv_.notify_all();
+          }
+          job.run();
+          nested_.store(nullptr);
+          //the helpers may still be running their last tile
+          while ( nested_helpers_.load() > 0 ) { sched_yield(); }
+          nested_cnt_++;
+          return true;
+        }
+
+        //wakes the workers up, they run the tasks pushed until end() is called
+        void begin( run_t run ) {
+          {
+            std::lock_guard<std::mutex> lock(park_lock_);
+            run_ = run;
+            steals_ = 0;
+            for (auto & queue: queues_) { queue->executed = 0; queue->idle_time = 0.0; queue->helped = 0; }
+            nested_cnt_ = 0;
+            done_.store(false,std::memory_order_release);
+            finished_ = 0;
+            epoch_++;
+          }
+          park_cv_.notify_all();
+        }
+
+        //waits for the workers to run out of tasks and parks them
+        void end() {
+          done_.store(true,std::memory_order_release);
+          {
+            std::lock_guard<std::mutex> lock(work_lock_);
+          }
+          work_cv_.notify_all();
+          std::unique_lock<std::mutex> lock(park_lock_);
+          park_cv_.wait(lock,[this]() { return finished_ == (int)threads_.size(); });
+          run_ = nullptr;
+        }
+
+        //joins the workers
+        void shutdown() {
+          {
+            std::lock_guard<std::mutex> lock(park_lock_);
+            shutdown_ = true;
+          }
+          park_cv_.notify_all();
+          for (auto && thread: threads_) thread.join();
+          threads_.clear();
+        }
+
+        int size() const { return threads_.size(); }
+
+        //true if the calling thread is a worker of this pool
+        bool on_worker() const { return current_ == this; }
+
+        void push( ttask_t * ptask ) {
+          active_++;
+          if ( on_worker() ) {
+            auto & queue = *queues_[worker_id_];
+            std::lock_guard<std::mutex> lock(queue.lock);
+            queue.tasks.push_back(ptask);
+          }
+          else {
+            std::lock_guard<std::mutex> lock(submitted_lock_);
+            submitted_.push_back(ptask);
+          }
+          signals_++;
+          if ( sleepers_.load() > 0 ) {
+            std::lock_guard<std::mutex> lock(work_lock_);
+            work_cv_.notify_one();
+          }
+        }
+
+        //called by a worker while it runs a task: pops the newest task of its own
+        //deque if accept returns true for it, the worker then runs it in the same call
+        ttask_t * pop_own_if( const std::function<bool(ttask_t *)> & accept ) {
+          if ( !on_worker() ) return nullptr;
+          auto & queue = *queues_[worker_id_];
+          std::lock_guard<std::mutex> lock(queue.lock);
+          if ( queue.tasks.empty() || !accept(queue.tasks.back()) ) return nullptr;
+          ttask_t * ptask = queue.tasks.back();
+          queue.tasks.pop_back();
+          //the task being run keeps active_ above 0 until both are done
+          queue.executed++;
+          active_--;
+          return ptask;
+        }
+
+        //no task is queued or running
+        bool idle() const { return active_.load(std::memory_order_acquire) == 0; }
+
+        //seconds spent by the workers looking for a task during the last execution
+        double idle_time() const {
+          double idle = 0.0;
+          for (auto & queue: queues_) { idle += queue->idle_time; }
+          return idle;
+        }
+
+        void print_stats( std::ostream & os ) const {
+          size_t executed = 0;
+          size_t helped = 0;
+          for (auto & queue: queues_) { executed += queue->executed; helped += queue->helped; }
+          os<<"Work stealing pool: "<<queues_.size()<<" workers"<<(pinned_?" (pinned)":"")<<", "<<executed<<" tasks, "<<steals_<<" steals (";
+          for (size_t id = 0; id < queues_.size(); id++) { os<<(id>0?" ":"")<<queues_[id]->executed; }
+          os<<"), idle "<<idle_time()<<" s"<<(backoff_?" (backoff)":"");
+          if ( this->min_flops > 0.0 ) { os<<", "<<nested_cnt_<<" tiled kernels, "<<helped<<" tiles helped"; }
+          os<<std::endl;
+        }
+
+      protected:
+        struct alignas(64) queue_t {
+          std::mutex lock;
+          std::deque<ttask_t *> tasks;
+          size_t executed;
+          double idle_time;
+          size_t helped;
+          queue_t():executed(0),idle_time(0.0),helped(0) {}
+        };
+
+        struct nested_job_t {
+          const std::function<void(int)> & body;
+          int ntiles;
+          std::atomic<int> next;
+          nested_job_t( const std::function<void(int)> & pbody, int pntiles ):body(pbody),ntiles(pntiles),next(0) {}
+          //runs tiles until none is left, returns how many
+          size_t run() {
+            size_t count = 0;
+            for (int tile = next++; tile < ntiles; tile = next++) { body(tile); count++; }
+            return count;
+          }
+        };
+
+        //runs the tiles left in the current tiled kernel, if any
+        size_t help_() {
+          //registered before looking at the job so that parallel_for waits for us
+          nested_helpers_++;
+          size_t count = 0;
+          nested_job_t * job = nested_.load();
+          if ( job != nullptr ) count = job->run();
+          nested_helpers_--;
+          return count;
+        }
+
+        static std::vector<int> allowed_cpus_() {
+          std::vector<int> cpus;
+          cpu_set_t set;
+          CPU_ZERO(&set);
+          if ( sched_getaffinity(0,sizeof(set),&set) == 0 ) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+              if ( CPU_ISSET(cpu,&set) ) cpus.push_back(cpu);
+            }
+          }
+          return cpus;
+        }
+
+        ttask_t * pop_local_( int id ) {
+          auto & queue = *queues_[id];
+          std::lock_guard<std::mutex> lock(queue.lock);
+          if ( queue.tasks.empty() ) return nullptr;
+          ttask_t * ptask = queue.tasks.back();
+          queue.tasks.pop_back();
+          return ptask;
+        }
+
+        ttask_t * pop_submitted_() {
+          std::lock_guard<std::mutex> lock(submitted_lock_);
+          if ( submitted_.empty() ) return nullptr;
+          ttask_t * ptask = submitted_.front();
+          submitted_.pop_front();
+          return ptask;
+        }
+
+        ttask_t * steal_( int id ) {
+          int nqueues = queues_.size();
+          for (int offset = 1; offset < nqueues; offset++) {
+            auto & queue = *queues_[(id+offset)%nqueues];
+            std::unique_lock<std::mutex> lock(queue.lock,std::try_to_lock);
+            if ( !lock.owns_lock() || queue.tasks.empty() ) continue;
+            ttask_t * ptask = queue.tasks.front();
+            queue.tasks.pop_front();
+            steals_++;
+            return ptask;
+          }
+          return nullptr;
+        }
+
+        //seen is the last execution started before the worker was created
+        void work_( int id, size_t seen ) {
+          while ( true ) {
+            {
+              std::unique_lock<std::mutex> lock(park_lock_);
+              park_cv_.wait(lock,[this,seen]() { return shutdown_ || epoch_ != seen; });
+              if ( shutdown_ ) break;
+              seen = epoch_;
+            }
+
+            auto & queue = *queues_[id];
+            int misses = 0;
+            auto idle_start = std::chrono::steady_clock::now();
+            while ( true ) {
+              //a push after this point makes the worker look again instead of sleeping
+              size_t signals = signals_.load();
+              ttask_t * ptask = pop_local_(id);
+              if ( ptask == nullptr ) ptask = pop_submitted_();
+              if ( ptask == nullptr ) ptask = steal_(id);
+              if ( ptask == nullptr && nested_.load(std::memory_order_relaxed) != nullptr ) {
+                if ( misses > 0 ) {
+                  queue.idle_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - idle_start).count();
+                  misses = 0;
+                }
+                queue.helped += this->help_();
+                continue;
+              }
+              if ( ptask != nullptr || done_.load(std::memory_order_acquire) ) {
+                if ( misses > 0 ) {
+                  queue.idle_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - idle_start).count();
+                  misses = 0;
+                }
+                if ( ptask == nullptr ) break;
+                run_(ptask);
+                queue.executed++;
+                active_--;
+              }
+              else {
+                if ( misses++ == 0 ) idle_start = std::chrono::steady_clock::now();
+                if ( backoff_ && misses > spin_rounds ) {
+                  std::unique_lock<std::mutex> lock(work_lock_);
+                  sleepers_++;
+                  work_cv_.wait_for(lock,max_wait,[this,signals]() {
+                      return signals_.load() != signals || done_.load(std::memory_order_acquire); });
+                  sleepers_--;
+                }
+                else {
+                  sched_yield();
+                }
+              }
+            }
+
+            {
+              std::lock_guard<std::mutex> lock(park_lock_);
+              finished_++;
+            }
+            park_cv_.notify_all();
+          }
+        }
+
+        std::vector< std::unique_ptr<queue_t> > queues_;
+        std::vector<std::thread> threads_;
+        std::mutex submitted_lock_;
+        std::deque<ttask_t *> submitted_;
+        run_t run_;
+        std::atomic<bool> done_;
+        //parking of the workers between executions, protected by park_lock_
+        std::mutex park_lock_;
+        std::condition_variable park_cv_;
+        bool shutdown_;
+        size_t epoch_;
+        int finished_;
+        std::atomic<int64_t> active_;
+        std::atomic<size_t> steals_;
+        bool pinned_;
+        //sleeping workers, woken up by push() and end()
+        bool backoff_;
+        std::mutex work_lock_;
+        std::condition_variable work_cv_;
+        std::atomic<size_t> signals_;
+        std::atomic<int> sleepers_;
+        //tiled kernel open to the idle workers
+        std::atomic<nested_job_t *> nested_;
+        std::atomic<int> nested_helpers_;
+        std::atomic<size_t> nested_cnt_;
+
+        static thread_local work_stealing_pool_t * current_;
+        static thread_local int worker_id_;
+    };
+
+  template <typename ttask_t>
+    constexpr std::chrono::microseconds work_stealing_pool_t<ttask_t>::max_wait;
+  template <typename ttask_t>
+    thread_local work_stealing_pool_t<ttask_t> * work_stealing_pool_t<ttask_t>::current_ = nullptr;
+  template <typename ttask_t>
+    thread_local int work_stealing_pool_t<ttask_t>::worker_id_ = -1;
+
+} // namespace symPACK
+
+#endif // _SYMPACK_WORK_STEALING_POOL_HPP_
@@ -10,43 +10,6 @@
 //Definitions of the WorkQueue class
 namespace symPACK{
 
-  template< typename ttask_t >
-    class worker_ptrs {
-      public: 
-        using atomic_ptr = std::atomic<ttask_t *>; 
-        atomic_ptr pointers[2];
-        int wslot_;
-        int rslot_;
-        worker_ptrs():pointers{{nullptr},{nullptr}},wslot_(0),rslot_(0){
-          bassert( nullptr== pointers[0].load(std::memory_order_acquire));
-          bassert( nullptr== pointers[1].load(std::memory_order_acquire));
-        }
-        virtual ~worker_ptrs() {
-          bassert( nullptr== pointers[0].load(std::memory_order_acquire));
-          bassert( nullptr== pointers[1].load(std::memory_order_acquire));
-        }
-
-        bool set(ttask_t * t){
-          ttask_t *  p = pointers[wslot_].load(std::memory_order_relaxed);
-          if (nullptr != p) {
-            return false;
-          }
-          pointers[wslot_].store(t, std::memory_order_release);
-          wslot_^=1;
-          return true;
-        }
-        
-        ttask_t * get(){
-          ttask_t * p = pointers[rslot_].load(std::memory_order_acquire);
-          if ( p != nullptr ){
-            pointers[rslot_].store(nullptr,std::memory_order_relaxed);
-            rslot_^=1;
-          }
-          
-          return p;
-        }
-    };
-
 #ifdef SP_THREADS
   template<typename T, typename Queue >
     inline WorkQueue<T, Queue >::WorkQueue(Int nthreads): done(false){
@@ -7,6 +7,13 @@
 
 
 #include "sympack/mpi_interf.hpp"
+#include "sympack/update_kernels.hpp"
+#include "sympack/CellArena.hpp"
+#include "sympack/LandingZonePool.hpp"
+#include "sympack/MessageAggregator.hpp"
+#ifdef SP_THREADS
+#include "sympack/WorkStealingPool.hpp"
+#endif
 
 #ifdef CUDA_MODE
 #include "cuda_runtime.h"
@@ -25,16 +32,16 @@
 
 #define _POINTER_EXCHANGE_
 #define _COMPACT_DEPENDENCIES_
+#define _FUSED_UPDATE_
 
 #define _PRIORITY_QUEUE_AVAIL_
 #define _PRIORITY_QUEUE_RDY_
 
 
-#define _USE_PROM_AVAIL_
-#define _USE_PROM_RDY_
-
 #include <functional>
 #include <chrono>
+#include <mutex>
+#include <condition_variable>
 
 
 #ifdef _PRIORITY_QUEUE_RDY_
@@ -240,110 +247,148 @@ namespace symPACK{
             using lock_t = std::atomic<bool>;
             lock_t * _lock_ptr;
 
+            //the type of the task is std::get<2>(_meta), its body is picked by a switch on it
             meta_t _meta;
+            //position in the task graph, its out dependencies are stored by the graph
+            std::size_t index;
 
-            std::function< void() > execute;
-
-            //byte storage for tasks 
-            std::unordered_map<int,std::list<std::size_t> > out_dependencies;
             //need counter here as same REMOTE cell can be input to many tasks.
             std::vector< std::shared_ptr< data_t > > input_msg;
 
             int in_remote_dependencies_cnt;
             int in_local_dependencies_cnt;
 
-#ifdef _USE_PROM_AVAIL_
-            //promise to wait for all incoming_data_t to be created
-            upcxx::promise<> in_avail_prom;
-            int in_avail_counter;
-#else
+            //decremented by whichever thread satisfies a dependency
+#ifdef SP_THREADS
             std::atomic<int> in_avail_counter;
-#endif
-
-#ifdef _USE_PROM_RDY_
-            //promise to sync on all incoming_data_t fetch
-            upcxx::promise<> in_prom;
-            int in_counter;
-#else
             std::atomic<int> in_counter;
+#else
+            int in_avail_counter;
+            int in_counter;
 #endif
 
+            //the thread bringing the counter to 0 hands the task to the scheduler
             template<typename T> 
               void satisfy_dep(int cnt,T&sched) {
-#ifdef _USE_PROM_RDY_
-                upcxx::master_persona().lpc_ff( 
-                    [this,cnt] () {
-                    bassert(this->in_counter-cnt >= 0);
-                    this->in_counter-=cnt;
-                    this->in_prom.fulfill_anonymous(cnt);
-                    });
-#else
-                T * sched_ptr = &sched;
-                upcxx::master_persona().lpc_ff( 
-                    [this,sched_ptr,cnt] () {
-                    this->in_counter-=cnt;
-                    if ( this->in_counter == 0 ) {
-#ifdef SP_THREADS
-                    if (sched_ptr->extraTaskHandle_!=nullptr) {
-                    bool delay = sched_ptr->extraTaskHandle_(this);
-                    if (delay) {
-                    sched_ptr->delayedTasks_[this->_lock_ptr].push_back(this);
-                    return;
-                    }
-                    }
-#endif
-                    push_ready(sched_ptr,this)
-                    }
-                    });
-#endif
+                int left = (this->in_counter-=cnt);
+                bassert(left >= 0);
+                if ( left == 0 ) {
+                  sched.push_ready_task(this);
+                }
               } 
 
             template<typename T> 
               void avail_dep(int cnt,T&sched) {
-#ifdef _USE_PROM_AVAIL_
-                upcxx::master_persona().lpc_ff( 
-                    [this,cnt] () {
-                    bassert(this->in_avail_counter-cnt >= 0);
-                    this->in_avail_counter-=cnt;
-                    this->in_avail_prom.fulfill_anonymous(cnt);
-                    });
-#else
-                T * sched_ptr = &sched;
-                upcxx::master_persona().lpc_ff( 
-                    [this,sched_ptr,cnt] () {
-                    bassert(this->in_avail_counter-cnt >= 0);
-                    this->in_avail_counter-=cnt;
-                    if ( this->in_avail_counter == 0 ) {
-                    push_avail(sched_ptr,this)
-                    }
-                    });
-#endif
+                int left = (this->in_avail_counter-=cnt);
+                bassert(left >= 0);
+                if ( left == 0 ) {
+                  sched.push_avail_task(this);
+                }
               } 
 
 
 
             bool executed;
+            //larger first in the ready and avail heaps
+            double priority;
+            //next task of the batch handed to a worker along with this one
+            task_t * batch_next;
 
-            task_t( ):executed(false),
-            _lock_ptr(nullptr),
+            task_t( ):executed(false),priority(0.0),batch_next(nullptr),
+            _lock_ptr(nullptr),index(0),
             in_remote_dependencies_cnt(0),
-            in_local_dependencies_cnt(0) { }
+            in_local_dependencies_cnt(0),
+            in_avail_counter(0),in_counter(0) { }
 
             virtual ~task_t() = default;
 
+            //(re)arm the counters from the dependency counts
+            void init_dependencies() {
+              in_avail_counter = in_remote_dependencies_cnt;
+              in_counter = in_local_dependencies_cnt + in_remote_dependencies_cnt;
+            }
+
             void reset() {
               input_msg.clear();
-#ifdef _USE_PROM_RDY_
-              in_prom = upcxx::promise<>();
-#endif
-#ifdef _USE_PROM_AVAIL_
-              in_avail_prom = upcxx::promise<>();
-#endif
               executed = false;
               _lock_ptr = nullptr;
+              batch_next = nullptr;
+            }
+
+        };
+
+    //contiguous run of task indices
+    struct task_range_t {
+      const std::size_t * first_;
+      const std::size_t * last_;
+      const std::size_t * begin() const { return first_; }
+      const std::size_t * end() const { return last_; }
+      std::size_t size() const { return last_ - first_; }
+      bool empty() const { return first_ == last_; }
+    };
+
+    //Out dependencies of the tasks of a graph in CSR form. The successors of
+    //task k are grouped by rank: for g in [first(k),last(k)), targets(g) are the
+    //indices of successors in the task graph of rank(g).
+    class out_dependencies_t {
+      public:
+        void clear() {
+          edges_.clear();
+          group_ptr_.clear();
+          ranks_.clear();
+          target_ptr_.clear();
+          targets_.clear();
+        }
+
+        //records an edge while the graph is built, returns its position for set()
+        std::size_t add( std::size_t task, int rank, std::size_t target ) {
+          edges_.push_back(edge_t{task,rank,target});
+          return edges_.size()-1;
+        }
+        void set( std::size_t edge, std::size_t target ) { edges_[edge].target = target; }
+
+        //builds the CSR arrays of ntasks tasks from the recorded edges
+        void finalize( std::size_t ntasks ) {
+          std::stable_sort(edges_.begin(),edges_.end(),[](const edge_t & a, const edge_t & b) {
+              return a.task < b.task || (a.task == b.task && a.rank < b.rank); });
+          group_ptr_.assign(ntasks+1,0);
+          ranks_.clear();
+          target_ptr_.clear();
+          targets_.clear();
+          targets_.reserve(edges_.size());
+          for (std::size_t e = 0; e < edges_.size(); e++) {
+            auto & edge = edges_[e];
+            if ( e == 0 || edge.task != edges_[e-1].task || edge.rank != edges_[e-1].rank ) {
+              ranks_.push_back(edge.rank);
+              target_ptr_.push_back(targets_.size());
+              group_ptr_[edge.task+1]++;
             }
+            targets_.push_back(edge.target);
+          }
+          target_ptr_.push_back(targets_.size());
+          std::partial_sum(group_ptr_.begin(),group_ptr_.end(),group_ptr_.begin());
+          std::vector<edge_t>().swap(edges_);
+        }
+
+        std::size_t first( std::size_t task ) const { return group_ptr_[task]; }
+        std::size_t last( std::size_t task ) const { return group_ptr_[task+1]; }
+        int rank( std::size_t group ) const { return ranks_[group]; }
+        task_range_t targets( std::size_t group ) const {
+          return task_range_t{targets_.data()+target_ptr_[group],targets_.data()+target_ptr_[group+1]};
+        }
 
+      protected:
+        struct edge_t {
+          std::size_t task;
+          int rank;
+          std::size_t target;
         };
+        std::vector<edge_t> edges_;
+        std::vector<std::size_t> group_ptr_;
+        std::vector<int> ranks_;
+        std::vector<std::size_t> target_ptr_;
+        std::vector<std::size_t> targets_;
+    };
 
 
     template <typename ttask_t = task_t<meta_t, depend_t> , typename tmeta_t = task_t<meta_t, depend_t>::meta_t>
@@ -360,7 +405,7 @@ namespace symPACK{
           meta_t in_meta;
           //a pointer to be used by the user if he wants to attach some data
           std::shared_ptr<blockCellBase_t> extra_data;
-	      incoming_data_t() : transfered(false),size(0),extra_data(nullptr),landing_zone(nullptr)
+	      incoming_data_t() : transfered(false),size(0),extra_data(nullptr),landing_zone(nullptr),mem_counter(nullptr),lz_pool(nullptr),is_view(false),on_release(nullptr)
 #ifdef CUDA_MODE
           ,d_landing_zone(nullptr), is_gpu_block(false), d_size(0)
 #endif
@@ -379,9 +424,33 @@ namespace symPACK{
           upcxx::global_ptr<char> remote_gptr;
           size_t size;
           char * landing_zone;
+          //landing zone bytes accounted by the scheduler, released with the landing zone
+          std::atomic<int64_t> * mem_counter;
+          //pool the landing zone comes from, if any
+          landing_zone_pool_t * lz_pool;
+          //landing_zone points directly to the producer storage on this node
+          bool is_view;
+          //called once the data is destroyed, i.e. when all its local consumers are done
+          std::function<void()> on_release;
+
+          //true if the producer storage can be read in place
+          bool viewable() const {
+#ifdef CUDA_MODE
+            if (is_gpu_block) return false;
+#endif
+            return remote_gptr.is_local();
+          }
 
-          void allocate() {
-            if (landing_zone == nullptr) landing_zone = new char[size];
+          void allocate( landing_zone_pool_t * pool = nullptr, bool allow_view = false ) {
+            if (landing_zone == nullptr) {
+              if ( allow_view && viewable() ) {
+                is_view = true;
+                landing_zone = remote_gptr.local();
+                return;
+              }
+              lz_pool = pool;
+              landing_zone = lz_pool ? lz_pool->allocate(size) : new char[size];
+            }
 #ifdef CUDA_MODE
             if (d_landing_zone==nullptr) d_landing_zone = symPACK::gpu_allocator.allocate<char>(size);
             if (d_landing_zone==nullptr) is_gpu_block=false;
@@ -389,7 +458,11 @@ namespace symPACK{
           }
 
           upcxx::future<incoming_data_t *> fetch() {
-            if (!transfered) {
+            if (!transfered && is_view) {
+              transfered=true;
+              on_fetch.fulfill_result(this);
+            }
+            else if (!transfered) {
               transfered=true;
 #ifdef CUDA_MODE
             if (is_gpu_block) {
@@ -414,7 +487,12 @@ namespace symPACK{
           }
 
           ~incoming_data_t() {
-            if (landing_zone) delete [] landing_zone;
+            if (landing_zone && !is_view) {
+              if (lz_pool) lz_pool->release(landing_zone,size);
+              else delete [] landing_zone;
+              if (mem_counter) *mem_counter -= size;
+            }
+            if (on_release) on_release();
 #ifdef CUDA_MODE
             if (d_landing_zone) symPACK::gpu_allocator.deallocate(d_landing_zone);
 #endif
@@ -428,6 +506,8 @@ namespace symPACK{
 
     template <typename label_t = key_t, typename ttask_t = task_t<meta_t, depend_t> >
       class task_graph_t3: public std::vector< std::unique_ptr<ttask_t> > {
+        public:
+          out_dependencies_t out_dependencies;
       };
 
 
@@ -438,24 +518,155 @@ namespace symPACK{
 
 
 #ifdef SP_THREADS
-
-          std::list< int > free_workers_;
-          std::vector< int > worker_loads_;
-          std::vector<worker_ptrs<ttask_t>> work_pointers_;
-          bool assignWork(ttask_t * ptask);
-
+          //workers kept from one execute to the next, joined with the scheduler
+          work_stealing_pool_t<ttask_t> pool_;
+          bool pin_threads_;
+          //run the tasks on a worker even with a single thread
+          bool progress_thread_;
+          //kernels of at least this many flops borrow the idle workers, 0 disables it
+          double nested_flops_;
+          bool on_worker() const { return this->pool_.on_worker(); }
+          //called by a worker once a task holding a cell lock is done
+          void release_lock_( typename ttask_t::lock_t * lock_ptr );
+
+          //tasks waiting for a cell lock, protected by delayed_mutex_
           std::map< typename ttask_t::lock_t *, std::list<ttask_t*> > delayedTasks_;
+          std::mutex delayed_mutex_;
           std::recursive_mutex scheduler_mutex_;
           std::function<void()> threadInitHandle_;
           std::function<void()> quiesceHandle_;
           std::function<bool(ttask_t *)> extraTaskHandle_;
-          Scheduler2D():threadInitHandle_(nullptr),extraTaskHandle_(nullptr),quiesceHandle_(nullptr) {}
-          virtual ~Scheduler2D() {
+#endif
+          //runs a task of the graph given to execute
+          std::function<void(ttask_t *)> runTaskHandle_;
+          //kind of a small task, -1 if the task is not batched. Consecutive ready
+          //tasks of the same kind are grouped, batch_size_ at most, and handed
+          //to runBatchHandle_ in a single call.
+          std::function<int(ttask_t *)> batchKeyHandle_;
+          std::function<void(ttask_t **,int)> runBatchHandle_;
+          int batch_size_;
+          std::atomic<size_t> batch_cnt_;
+          std::atomic<size_t> batched_tasks_;
+          int batch_key_( ttask_t * ptask ) const { return this->batchKeyHandle_ != nullptr ? this->batchKeyHandle_(ptask) : -1; }
+          //runs the tasks of batch, all of the same kind
+          void run_batch_( std::vector<ttask_t*> & batch );
+
+          //after idle_spin_rounds rounds without work, the scheduling loop waits on
+          //idle_cv_ instead of spinning, doubling the wait up to idle_max_wait_us.
+          //Tasks handed to the master by other threads end the wait (wake_master_),
+          //UPC++ cannot signal incoming communications, so the wait is bounded.
+          static const int idle_spin_rounds = 64;
+          static const int idle_max_wait_us = 256;
+          bool idle_backoff_;
+          //seconds spent without work during the last execute: by the master in the
+          //sequential loop, by the workers (summed) when a pool runs the tasks
+          double idle_time_;
+          bool idle_workers_;
+          int idle_rounds_;
+          int idle_wait_us_;
+          std::chrono::steady_clock::time_point idle_start_;
+          std::mutex idle_mutex_;
+          std::condition_variable idle_cv_;
+          //bumped for every task handed to the master, idle_seen_ is the last value it handled
+          std::atomic<size_t> idle_signals_;
+          size_t idle_seen_;
+          std::atomic<bool> idle_waiting_;
+          void idle_round_( bool busy );
+          void wake_master_() {
+            this->idle_signals_++;
+            if ( this->idle_waiting_.load() ) {
+              std::lock_guard<std::mutex> lock(this->idle_mutex_);
+              this->idle_cv_.notify_all();
+            }
           }
+
+          //called once per round of the scheduling loop, with true when this rank
+          //runs out of ready tasks and once all the local tasks are done
+          std::function<void(bool)> progressHandle_;
+          Scheduler2D():
+#ifdef SP_THREADS
+            pin_threads_(false),progress_thread_(false),nested_flops_(0.0),threadInitHandle_(nullptr),extraTaskHandle_(nullptr),quiesceHandle_(nullptr),
 #endif
+            runTaskHandle_(nullptr),batchKeyHandle_(nullptr),runBatchHandle_(nullptr),batch_size_(0),batch_cnt_(0),batched_tasks_(0),idle_backoff_(false),idle_time_(0.0),idle_workers_(false),idle_rounds_(0),idle_signals_(0),idle_seen_(0),idle_waiting_(false),idle_wait_us_(1),progressHandle_(nullptr),lz_bytes_(0),lz_peak_bytes_(0),fetches_in_flight_(0),stalled_rounds_(0),mem_budget_(-1.0),local_views_(false),local_view_cnt_(0),local_view_bytes_(0),eager_cnt_(0),eager_bytes_(0) {}
+          virtual ~Scheduler2D() {
+          }
+
+          using data_t = typename ttask_t::data_t;
+          //bytes currently held by the landing zones of incoming data
+          std::atomic<int64_t> lz_bytes_;
+          int64_t lz_peak_bytes_;
+          int fetches_in_flight_;
+          int stalled_rounds_;
+          //landing zone budget in bytes, unlimited if not positive
+          double mem_budget_;
+          //available tasks whose fetch was postponed because of the budget
+          std::list<ttask_t*> deferred_avail_;
+          //recycled landing zones, used if its capacity is not 0
+          landing_zone_pool_t lz_pool_;
+          //read the cells produced on this node in place instead of fetching them
+          bool local_views_;
+          size_t local_view_cnt_;
+          size_t local_view_bytes_;
+          //cells received inside the notifying rpc
+          size_t eager_cnt_;
+          size_t eager_bytes_;
+
+          bool fits_budget( size_t bytes ) const {
+            return this->mem_budget_ <= 0 || (double)(this->lz_bytes_ + bytes) <= this->mem_budget_;
+          }
+
+          //bytes of the landing zones not yet allocated for the inputs of ptask
+          size_t pending_fetch_bytes( ttask_t * ptask ) const {
+            size_t bytes = 0;
+            for (auto & msg : ptask->input_msg) {
+              if ( msg->landing_zone == nullptr && !(this->local_views_ && msg->viewable()) ) bytes += msg->size;
+            }
+            return bytes;
+          }
+
+          //true if ptask becomes ready once its inputs are fetched
+          bool fetch_unblocks( ttask_t * ptask ) const {
+            return ptask->in_counter <= (int)ptask->input_msg.size();
+          }
+
+          //true if all the inputs of ptask already are in their landing zones
+          bool inputs_received( ttask_t * ptask ) const {
+            for (auto & msg : ptask->input_msg) {
+              if ( !msg->transfered ) return false;
+            }
+            return true;
+          }
+
+          void allocate_landing_zone( data_t & msg, bool allow_view );
+          void start_fetch( data_t & msg );
+          //called from the rpcs carrying the cell: the payload only lives
+          //during the rpc so it is copied in a landing zone, no fetch is needed
+          template <typename iter_t>
+            void receive_eager( data_t & msg, iter_t first, iter_t last ) {
+              bassert( (size_t)std::distance(first,last) == msg.size );
+#ifdef CUDA_MODE
+              //inlined cells stay on the host
+              msg.is_gpu_block = false;
+#endif
+              this->allocate_landing_zone(msg,false);
+              std::copy(first,last,msg.landing_zone);
+              msg.transfered = true;
+              msg.on_fetch.fulfill_result(&msg);
+              this->eager_cnt_++;
+              this->eager_bytes_ += msg.size;
+            }
+          //called from the rpcs: fetch right away only if the landing zone fits
+          void eager_fetch( data_t & msg ) {
+            if ( (this->local_views_ && msg.viewable()) || this->fits_budget(msg.size) ) this->start_fetch(msg);
+          }
+          void fetch_inputs( ttask_t * ptask );
+          void process_avail( bool idle );
 #ifdef _PRIORITY_QUEUE_AVAIL_
           struct avail_comp{
             bool operator()(ttask_t *& a,ttask_t*& b) { 
+              //priorities are all 0 unless bottom level priorities are used
+              if ( a->priority != b->priority )
+                return a->priority < b->priority;
               auto tgt_a = std::get<1>(a->_meta);
               auto tgt_b = std::get<1>(b->_meta);
               if ( tgt_a != tgt_b )
@@ -474,6 +685,9 @@ namespace symPACK{
 #ifdef _PRIORITY_QUEUE_RDY_
           struct rdy_comp{
             bool operator()(ttask_t *& a,ttask_t*& b) { 
+              //priorities are all 0 unless bottom level priorities are used
+              if ( a->priority != b->priority )
+                return a->priority < b->priority;
               auto tgt_a = std::get<1>(a->_meta);
               auto tgt_b = std::get<1>(b->_meta);
               if ( tgt_a != tgt_b )
@@ -489,6 +703,15 @@ namespace symPACK{
           std::list<ttask_t*> ready_tasks;
 #endif
 
+          //pops the top ready task and the ready tasks of the same kind following it
+          void pop_ready_batch_( std::vector<ttask_t*> & batch );
+
+          //queues a task whose dependencies are satisfied: tasks waiting for a
+          //cell lock are delayed, tasks made ready by a worker go to its deque,
+          //other threads hand the task to the master persona
+          void push_ready_task( ttask_t * ptask );
+          //queues a task whose inputs are all known so that they get fetched
+          void push_avail_task( ttask_t * ptask );
           void execute(ttaskgraph_t & graph, double & mem_budget );
       };
 
@@ -496,6 +719,40 @@ namespace symPACK{
 
   extern std::map<int, symPACKMatrixBase *  > g_sp_handle_to_matrix;
 
+  //relative indices of the update of a target cell by a (pivot,facing) pair.
+  //They only depend on the symbolic structure, so they are computed the first
+  //time the update runs and reused by subsequent factorizations.
+  template <typename rowind_t>
+    class update_map_t {
+      public:
+        class run_t {
+          public:
+            //first row (or column) in the GEMM output buffer
+            rowind_t first;
+            rowind_t count;
+            //offset of the first entry in the target cell
+            size_t offset;
+        };
+
+        bool computed;
+        bool in_place;
+        size_t tgt_offset;
+        //contiguous rows of the buffer landing in contiguous rows of a target block
+        std::vector<run_t> row_runs;
+        //contiguous columns of the buffer landing in contiguous target columns
+        std::vector<run_t> col_runs;
+
+        update_map_t():computed(false),in_place(false),tgt_offset(0) {}
+
+        void reset() {
+          computed = false;
+          in_place = false;
+          tgt_offset = 0;
+          row_runs.clear();
+          col_runs.clear();
+        }
+    };
+
   template <typename colptr_t, typename rowind_t, typename T, typename int_t = int> 
     class blockCell_t: public blockCellBase_t {
       protected:
@@ -639,8 +896,10 @@ namespace symPACK{
 #ifdef CUDA_MODE
           _d_nzval(nullptr), is_gpu_block(false),
 #endif
-	      _gstorage(nullptr),_nnz(0),  _storage_size(0), _own_storage(true) {}
+	      _gstorage(nullptr),_nnz(0),  _storage_size(0), _own_storage(true), _arena_storage(false) {}
         bool _own_storage;
+        //storage belongs to a cell_arena_t and is released with it
+        bool _arena_storage;
 
         virtual ~blockCell_t() {
           if (_own_storage) {
@@ -650,7 +909,7 @@ namespace symPACK{
 #endif
             if ( !_gstorage.is_null() ) {
               bassert(_storage == _gstorage.local());
-              upcxx::deallocate( _gstorage );
+              if ( !_arena_storage ) upcxx::deallocate( _gstorage );
             }
             else {
               delete [] _storage;
@@ -663,12 +922,12 @@ namespace symPACK{
         }
 
         //This is only called during FUC and BUC
-        blockCell_t ( int_t i, int_t j, rowind_t firstcol, rowind_t width, size_t nzval_cnt, size_t block_cnt, bool shared_segment = true ): blockCell_t() {
+        blockCell_t ( int_t i, int_t j, rowind_t firstcol, rowind_t width, size_t nzval_cnt, size_t block_cnt, bool shared_segment = true, cell_arena_t * arena = nullptr ): blockCell_t() {
             this->i = i;
             this->j = j;
             _dims = std::make_tuple(width);
             first_col = firstcol;
-            allocate(nzval_cnt,block_cnt, shared_segment);
+            allocate(nzval_cnt,block_cnt, shared_segment, arena);
 	}
 
 	blockCell_t (  int_t i, int_t j,char * ext_storage, rowind_t firstcol, rowind_t width, size_t nzval_cnt, size_t block_cnt ): blockCell_t() {
@@ -758,6 +1017,7 @@ namespace symPACK{
 
           _gstorage = other._gstorage;
           _storage = other._storage;
+          _arena_storage = other._arena_storage;
 
           initialize( other._cnz , other._cblocks );
 
@@ -786,7 +1046,7 @@ namespace symPACK{
           {  
             // Free the existing resource.  
             if ( ! _gstorage.is_null() ) {
-              upcxx::deallocate( _gstorage );
+              if ( !_arena_storage ) upcxx::deallocate( _gstorage );
             }
             else {
               delete [] _storage;
@@ -820,7 +1080,7 @@ namespace symPACK{
           {  
             // Free the existing resource.  
             if ( !_gstorage.is_null() ) {
-              upcxx::deallocate( _gstorage );
+              if ( !_arena_storage ) upcxx::deallocate( _gstorage );
             }
             else {
               delete [] _storage;
@@ -836,6 +1096,7 @@ namespace symPACK{
 
             _gstorage = other._gstorage;
             _storage = other._storage;
+            _arena_storage = other._arena_storage;
 
             initialize( other._cnz , other._cblocks );
 
@@ -912,7 +1173,7 @@ namespace symPACK{
 
         }
 
-        void allocate ( size_t nzval_cnt, size_t block_cnt, bool shared_segment ) {
+        void allocate ( size_t nzval_cnt, size_t block_cnt, bool shared_segment, cell_arena_t * arena = nullptr ) {
           bassert(nzval_cnt!=0 && block_cnt!=0);
  
 #ifdef _ALIGNED_
@@ -920,12 +1181,19 @@ namespace symPACK{
 #endif
 
           if ( shared_segment ) {
+            _arena_storage = false;
+            if ( arena ) {
+              _gstorage = arena->allocate( nzval_cnt*sizeof(T) + block_cnt*sizeof(block_t) );
+              _arena_storage = !_gstorage.is_null();
+            }
 
+            if ( !_arena_storage ) {
 #ifdef _ALIGNED_
-            _gstorage = upcxx::allocate<char, alignof(T) >( aligned_size ); 
+              _gstorage = upcxx::allocate<char, alignof(T) >( aligned_size ); 
 #else
-            _gstorage = upcxx::allocate<char>( nzval_cnt*sizeof(T) + block_cnt*sizeof(block_t) );
+              _gstorage = upcxx::allocate<char>( nzval_cnt*sizeof(T) + block_cnt*sizeof(block_t) );
 #endif
+            }
             _storage = _gstorage.local();
             if ( this->_storage==nullptr ) symPACKOS<<"Trying to allocate "<<nzval_cnt<<" for cell ("<<i<<","<<j<<")"<<std::endl;
             assert( this->_storage!=nullptr );
@@ -1049,7 +1317,7 @@ namespace symPACK{
     
 #endif
 
-        virtual int factorize( TempUpdateBuffers<T> & tmpBuffers) {
+        virtual int factorize( TempUpdateBuffers<T> & tmpBuffers, const kernels::narrow_limits_t & limits ) {
           scope_timer(a,blockCell_t::factorize);
 #if defined(_NO_COMPUTATION_)
           return 0;
@@ -1058,8 +1326,14 @@ namespace symPACK{
           auto snode_size = std::get<0>(_dims);
           auto diag_nzval = _nzval;
           try {
-            auto potrf_cpu = [snode_size, diag_nzval](){
+            int narrow_width = limits.potrf;
+            auto potrf_cpu = [snode_size, diag_nzval, narrow_width](){
                 symPACK::increment_counter(symPACK::cpu_ops, "potrf");
+                int info = 0;
+                if ( snode_size <= narrow_width && kernels::potrf_narrow((int)snode_size, diag_nzval, info) ) {
+                  if ( info > 0 ) { throw std::runtime_error("Matrix is not HPD."); }
+                  return;
+                }
                 lapack::Potrf( 'U', snode_size, diag_nzval, snode_size);
             };
 #ifdef CUDA_MODE
@@ -1101,7 +1375,7 @@ namespace symPACK{
           return 0;
         }
 
-        virtual int trsm( const blockCellBase_t * pdiag, TempUpdateBuffers<T> & tmpBuffers) {
+        virtual int trsm( const blockCellBase_t * pdiag, TempUpdateBuffers<T> & tmpBuffers, const kernels::narrow_limits_t & limits ) {
 #if defined(_NO_COMPUTATION_)
           return 0;
 #endif
@@ -1115,12 +1389,17 @@ namespace symPACK{
           auto diag_nzval = diag->_nzval;
           auto nzblk_nzval = _nzval;
           int n_rows = total_rows();
-          auto trsm_cpu = [snode_size, n_rows, diag_nzval, nzblk_nzval](){
+          bool narrow = snode_size <= limits.trsm;
+          auto trsm_cpu = [snode_size, n_rows, diag_nzval, nzblk_nzval, narrow](){
             symPACK::increment_counter(symPACK::cpu_ops, "trsm");
-            blas::Trsm('L','U','T','N',
-                        snode_size, n_rows, 
-                        T(1.0),  diag_nzval, snode_size, 
-                        nzblk_nzval, snode_size);
+            //the rows of the cell are independent right hand sides
+            kernels::run_tiled(n_rows, FLOPS_DTRSM('L',(double)snode_size,(double)n_rows), [&](int64_t first, int64_t count) {
+                if ( narrow && kernels::trsm_narrow((int)snode_size, count, diag_nzval, nzblk_nzval + first*snode_size) ) { return; }
+                blas::Trsm('L','U','T','N',
+                            snode_size, count, 
+                            T(1.0),  diag_nzval, snode_size, 
+                            nzblk_nzval + first*snode_size, snode_size);
+                });
           };
 #ifdef CUDA_MODE
           if (diag->is_gpu_block || snode_size*total_rows() > symPACK::trsm_limit) {
@@ -1177,7 +1456,122 @@ namespace symPACK{
           return 0;
         }
 
-        virtual int update( blockCellBase_t * ppivot, blockCellBase_t * pfacing, TempUpdateBuffers<T> & tmpBuffers, T* diag = nullptr) {
+        //builds the row and column runs used to scatter a non in-place update
+        void compute_update_map( blockCell_t & pivot, blockCell_t & facing, update_map_t<rowind_t> & map ) {
+          auto tgt_snode_size = std::get<0>(_dims);
+          map.row_runs.clear();
+          map.col_runs.clear();
+
+          rowind_t rowidx = 0;
+          block_t * tgt_ptr = _block_container._blocks;   
+          for ( auto & cur_block: facing.blocks() ) {
+            rowind_t cur_src_nrows = facing.block_nrows(cur_block);
+            rowind_t cur_src_lr = cur_block.first_row + cur_src_nrows -1;
+            rowind_t cur_src_fr = cur_block.first_row;
+
+            //The other one MUST reside into a single block in the target
+            rowind_t row = cur_src_fr;
+            while (row<=cur_src_lr) {
+              do {
+                if (tgt_ptr->first_row <= row 
+                    && row< tgt_ptr->first_row + block_nrows(*tgt_ptr) ) {
+                  break;
+                }                 
+              } while ( ++tgt_ptr<_block_container._blocks + _block_container._nblocks );                  
+
+              rowind_t lr = std::min(cur_src_lr,(rowind_t)(tgt_ptr->first_row + block_nrows(*tgt_ptr)-1));
+              size_t tgtOffset = tgt_ptr->offset + (row - tgt_ptr->first_row)*tgt_snode_size;
+              map.row_runs.push_back({rowidx,(rowind_t)(lr-row+1),tgtOffset});
+              rowidx += lr-row+1;
+              row = lr+1;
+            }
+          }
+
+          rowind_t colidx = 0;
+          for ( auto & cur_block: pivot.blocks() ) {
+            rowind_t cur_src_ncols = pivot.block_nrows(cur_block);
+            rowind_t cur_src_lc = std::min(cur_block.first_row + cur_src_ncols -1, this->first_col+this->width()-1);
+            rowind_t cur_src_fc = std::max(cur_block.first_row,this->first_col);
+            if ( cur_src_fc <= cur_src_lc ) {
+              map.col_runs.push_back({colidx,(rowind_t)(cur_src_lc-cur_src_fc+1),(size_t)(cur_src_fc-this->first_col)});
+              colidx += cur_src_lc-cur_src_fc+1;
+            }
+          }
+          map.computed = true;
+        }
+
+        //adds the GEMM output buffer (ldbuf = tgt_width) to the target cell
+        void scatter_update( const update_map_t<rowind_t> & map, const T * buf, int_t tgt_width ) {
+          auto tgt_snode_size = std::get<0>(_dims);
+          T * tgt = this->_nzval;
+          for ( auto & rrun: map.row_runs ) {
+            for (rowind_t r = 0; r < rrun.count; ++r) {
+              const T * A = &buf[(rrun.first+r)*tgt_width];
+              T * B = &tgt[rrun.offset + r*tgt_snode_size];
+              for ( auto & crun: map.col_runs ) {
+                const T * a = A + crun.first;
+                T * b = B + crun.offset;
+                for (rowind_t c = 0; c < crun.count; ++c) { b[c] += a[c]; }
+              }
+            }
+          }
+        }
+
+        //fills tmpBuffers.src_to_tgt_offset with the target offset of every facing row
+        //and tmpBuffers.src_colindx with the local target column of every pivot row
+        void update_offsets( blockCell_t & pivot, blockCell_t & facing, update_map_t<rowind_t> * pmap, TempUpdateBuffers<T> & tmpBuffers ) {
+          auto tgt_snode_size = std::get<0>(_dims);
+          update_map_t<rowind_t> lmap;
+          auto & map = pmap != nullptr ? *pmap : lmap;
+          if ( !map.computed ) {
+            SYMPACK_TIMER_SPECIAL_START(UPDATE_SNODE_INDEX_MAP);
+            compute_update_map(pivot,facing,map);
+            SYMPACK_TIMER_SPECIAL_STOP(UPDATE_SNODE_INDEX_MAP);
+          }
+
+          tmpBuffers.src_to_tgt_offset.resize(facing.total_rows());
+          tmpBuffers.src_colindx.resize(pivot.total_rows());
+          for ( auto & rrun: map.row_runs ) {
+            for (rowind_t r = 0; r < rrun.count; ++r) {
+              tmpBuffers.src_to_tgt_offset[rrun.first+r] = rrun.offset + r*tgt_snode_size;
+            }
+          }
+          for ( auto & crun: map.col_runs ) {
+            for (rowind_t c = 0; c < crun.count; ++c) {
+              tmpBuffers.src_colindx[crun.first+c] = crun.offset + c;
+            }
+          }
+        }
+
+        //computes the update straight into the target rows, without going through tmpBuf.
+        //Bt is the pivot cell stored as src_snode_size x tgt_width with leading dimension ldb
+        void fused_update( blockCell_t & pivot, blockCell_t & facing, const T * Bt, int_t ldb, update_map_t<rowind_t> * pmap, TempUpdateBuffers<T> & tmpBuffers ) {
+          update_offsets(pivot,facing,pmap,tmpBuffers);
+          Int src_snode_size = std::get<0>(pivot._dims);
+          Int src_nrows = facing.total_rows();
+          Int tgt_width = pivot.total_rows();
+          symPACK::increment_counter(symPACK::cpu_ops, "gemm");
+          kernels::gemm_scatter(src_nrows, tgt_width, src_snode_size,
+              (const T*)facing._nzval, src_snode_size, Bt, (Int)ldb,
+              this->_nzval, tmpBuffers.src_to_tgt_offset.data(), tmpBuffers.src_colindx.data());
+        }
+
+        //decides whether a non in-place update goes through the fused kernel
+        bool use_fused_update( bool in_place, rowind_t src_nrows, int_t tgt_width, rowind_t src_snode_size ) {
+#ifdef _FUSED_UPDATE_
+          bool fused = !in_place && kernels::use_fused_update<T>(src_nrows,tgt_width,src_snode_size);
+#ifdef CUDA_MODE
+          fused = fused && tgt_width * src_nrows <= symPACK::gemm_limit 
+            && tgt_width * src_snode_size <= symPACK::gemm_limit 
+            && src_nrows * src_snode_size <= symPACK::gemm_limit;
+#endif
+          return fused;
+#else
+          return false;
+#endif
+        }
+
+        virtual int update( blockCellBase_t * ppivot, blockCellBase_t * pfacing, TempUpdateBuffers<T> & tmpBuffers, const kernels::narrow_limits_t & limits, T* diag = nullptr, update_map_t<rowind_t> * pmap = nullptr) {
 #if defined(_NO_COMPUTATION_)
           return 0;
 #endif
@@ -1232,7 +1626,11 @@ namespace symPACK{
             size_t tgt_offset = 0;
             bool in_place = ( first_pivot_idx == last_pivot_idx );
 
-            if (in_place) { 
+            if ( pmap != nullptr && pmap->computed ) {
+              in_place = pmap->in_place;
+              tgt_offset = pmap->tgt_offset;
+            }
+            else if (in_place) { 
               int tgt_first_upd_blk_idx  = 0;
               for ( ; tgt_first_upd_blk_idx < this->_block_container.size(); tgt_first_upd_blk_idx++ ) {
                 auto & block = this->_block_container[tgt_first_upd_blk_idx];
@@ -1268,6 +1666,24 @@ namespace symPACK{
                 in_place = false;
               }
             }
+            if ( pmap != nullptr && !pmap->computed ) {
+              pmap->in_place = in_place;
+              pmap->tgt_offset = tgt_offset;
+              //nothing else to remember for in place updates
+              pmap->computed = in_place;
+            }
+
+            if ( use_fused_update(in_place,src_nrows,tgt_width,src_snode_size) ) {
+              SYMPACK_TIMER_SPECIAL_START(UPDATE_SNODE_FUSED);
+              //pack the pivot block so that the kernel reads it with unit stride
+              tmpBuffers.tmpBuf.resize(tgt_width*src_snode_size);
+              T * Bt = &tmpBuffers.tmpBuf[0];
+              kernels::pack_transpose(tgt_width,(int_t)src_snode_size,pivot_nzval,(int_t)src_snode_size,Bt);
+              fused_update(pivot,facing,Bt,tgt_width,pmap,tmpBuffers);
+              SYMPACK_TIMER_SPECIAL_STOP(UPDATE_SNODE_FUSED);
+              return 0;
+            }
+
             int ldbuf = tgt_width;
             if (in_place) {
               buf = tgt + tgt_offset;
@@ -1280,11 +1696,26 @@ namespace symPACK{
               buf = &tmpBuffers.tmpBuf[0];
             }
 
+            //narrow source supernodes use the width specialized kernels on the packed pivot
+            T * narrow_pivot = nullptr;
+            if ( src_snode_size <= limits.update && src_snode_size <= kernels::narrow_max_width ) {
+              if ( in_place ) {
+                tmpBuffers.tmpBuf.resize(src_snode_size*tgt_width);
+                narrow_pivot = &tmpBuffers.tmpBuf[0];
+              }
+              else {
+                narrow_pivot = &tmpBuffers.tmpBuf[tgt_width*src_nrows];
+              }
+              kernels::pack_transpose(tgt_width,(int_t)src_snode_size,pivot_nzval,(int_t)src_snode_size,narrow_pivot);
+            }
+
             if ( in_place && this->i == this->j ) {
               bassert(src_nrows==tgt_width);
               SYMPACK_TIMER_SPECIAL_START(UPDATE_SNODE_SYRK);
-              auto syrk_cpu = [tgt_width, pivot_nzval, src_snode_size, beta, buf, ldbuf]() { 
+              auto syrk_cpu = [tgt_width, pivot_nzval, src_snode_size, beta, buf, ldbuf, narrow_pivot]() { 
                     symPACK::increment_counter(symPACK::cpu_ops, "syrk");
+                    if ( narrow_pivot != nullptr && kernels::update_narrow((int)src_snode_size, tgt_width, tgt_width,
+                          (const T*)narrow_pivot, (const T*)pivot_nzval, beta, buf, ldbuf, true) ) { return; }
                     blas::Syrk('U','T',tgt_width, src_snode_size, 
                                 T(-1.0), pivot_nzval, src_snode_size, 
                                 beta, buf, ldbuf);
@@ -1334,11 +1765,16 @@ namespace symPACK{
               //everything is in row-major
               SYMPACK_TIMER_SPECIAL_START(UPDATE_SNODE_GEMM);
               auto gemm_cpu = [tgt_width, src_nrows, src_snode_size, 
-                               pivot_nzval, facing_nzval, beta, buf, ldbuf]() {
+                               pivot_nzval, facing_nzval, beta, buf, ldbuf, narrow_pivot]() {
                     symPACK::increment_counter(symPACK::cpu_ops, "gemm");
-                    blas::Gemm('T','N',tgt_width, src_nrows,src_snode_size,
-                                T(-1.0),pivot_nzval,src_snode_size,
-                                facing_nzval,src_snode_size,beta,buf,ldbuf);
+                    //each row of the facing cell updates its own row of buf
+                    kernels::run_tiled(src_nrows, FLOPS_DGEMM((double)tgt_width,(double)src_nrows,(double)src_snode_size), [&](int64_t first, int64_t count) {
+                        if ( narrow_pivot != nullptr && kernels::update_narrow((int)src_snode_size, tgt_width, count, (const T*)narrow_pivot,
+                              (const T*)facing_nzval + first*src_snode_size, beta, buf + first*ldbuf, ldbuf, false) ) { return; }
+                        blas::Gemm('T','N',tgt_width, count,src_snode_size,
+                                    T(-1.0),pivot_nzval,src_snode_size,
+                                    facing_nzval + first*src_snode_size,src_snode_size,beta,buf + first*ldbuf,ldbuf);
+                        });
               };
 #ifdef CUDA_MODE
               if (tgt_width * src_nrows > symPACK::gemm_limit ||
@@ -1392,7 +1828,17 @@ namespace symPACK{
 
             //If the GEMM wasn't done in place we need to aggregate the update
             //This is the assembly phase
-            if (!in_place) {
+            if (!in_place && pmap != nullptr) {
+              if ( !pmap->computed ) {
+                SYMPACK_TIMER_SPECIAL_START(UPDATE_SNODE_INDEX_MAP);
+                compute_update_map(pivot,facing,*pmap);
+                SYMPACK_TIMER_SPECIAL_STOP(UPDATE_SNODE_INDEX_MAP);
+              }
+              SYMPACK_TIMER_SPECIAL_START(UPDATE_SNODE_ADD);
+              scatter_update(*pmap,buf,tgt_width);
+              SYMPACK_TIMER_SPECIAL_STOP(UPDATE_SNODE_ADD);
+            }
+            else if (!in_place) {
               SYMPACK_TIMER_SPECIAL_START(UPDATE_SNODE_INDEX_MAP);
               tmpBuffers.src_colindx.resize(tgt_width);
               tmpBuffers.src_to_tgt_offset.resize(src_nrows);
@@ -1468,14 +1914,14 @@ namespace symPACK{
           return 0;
         }
 
-        virtual void copy_row_structure( int_t width, blockCell_t * other ) { 
+        virtual void copy_row_structure( int_t width, blockCell_t * other, cell_arena_t * arena = nullptr ) { 
           this->i = other->i;
           this->j = other->j;
           //check if the block has been initialized yet
           int_t nnz = width * other->total_rows();
           this->_dims = std::make_tuple(width);
           this->first_col = other->first_col;
-          this->allocate(nnz,other->nblocks(),true);
+          this->allocate(nnz,other->nblocks(),true,arena);
           this->initialize(nnz,other->nblocks());
      	  for ( auto & cur_block: other->blocks() ) {
             this->add_block(cur_block.first_row,other->block_nrows(cur_block));          
@@ -1818,22 +2264,22 @@ namespace symPACK{
           if ( this->_bufLDL ) delete [] this->_bufLDL;
         }
 
-        blockCellLDL_t (  int_t i, int_t j, rowind_t firstcol, rowind_t width, size_t nzval_cnt, size_t block_cnt, bool shared_segment = true  ): blockCellLDL_t<colptr_t,rowind_t, T>() {
+        blockCellLDL_t (  int_t i, int_t j, rowind_t firstcol, rowind_t width, size_t nzval_cnt, size_t block_cnt, bool shared_segment = true, cell_arena_t * arena = nullptr  ): blockCellLDL_t<colptr_t,rowind_t, T>() {
           this->i = i;
           this->j = j;
           this->_dims = std::make_tuple(width);
           this->first_col = firstcol;
-          this->allocate(nzval_cnt,block_cnt, shared_segment);
+          this->allocate(nzval_cnt,block_cnt, shared_segment, arena);
           this->initialize(nzval_cnt,block_cnt);
         }
 
 
-        blockCellLDL_t (  int_t i, int_t j, rowind_t firstcol, rowind_t width, size_t nzval_cnt, size_t block_cnt, int_t diag_cnt, bool shared_segment = true  ): blockCellLDL_t<colptr_t,rowind_t, T>() {
+        blockCellLDL_t (  int_t i, int_t j, rowind_t firstcol, rowind_t width, size_t nzval_cnt, size_t block_cnt, int_t diag_cnt, bool shared_segment = true, cell_arena_t * arena = nullptr  ): blockCellLDL_t<colptr_t,rowind_t, T>() {
           this->i = i;
           this->j = j;
           this->_dims = std::make_tuple(width);
           this->first_col = firstcol;
-          this->allocate(nzval_cnt,block_cnt, shared_segment);
+          this->allocate(nzval_cnt,block_cnt, shared_segment, arena);
           this->initialize(nzval_cnt,block_cnt);
         }
 
@@ -1895,6 +2341,7 @@ namespace symPACK{
 
           this->_gstorage = other._gstorage;
           this->_storage = other._storage;
+          this->_arena_storage = other._arena_storage;
           initialize( other._cnz , other._cblocks );
 
           //invalidate other
@@ -1917,7 +2364,7 @@ namespace symPACK{
           {  
             // Free the existing resource.  
             if ( ! this->_gstorage.is_null() ) {
-              upcxx::deallocate( this->_gstorage );
+              if ( !this->_arena_storage ) upcxx::deallocate( this->_gstorage );
             }
             else {
               delete [] this->_storage;
@@ -1946,7 +2393,7 @@ namespace symPACK{
           {  
             // Free the existing resource.  
             if ( !this->_gstorage.is_null() ) {
-              upcxx::deallocate( this->_gstorage );
+              if ( !this->_arena_storage ) upcxx::deallocate( this->_gstorage );
             }
             else {
               delete [] this->_storage;
@@ -1962,6 +2409,7 @@ namespace symPACK{
 
             this->_gstorage = other._gstorage;
             this->_storage = other._storage;
+            this->_arena_storage = other._arena_storage;
             initialize( other._cnz , other._cblocks );
 
             //invalidate other
@@ -2007,11 +2455,21 @@ namespace symPACK{
           }
         }
 
-        void allocate ( size_t nzval_cnt, size_t block_cnt, bool shared_segment ) {
+        void allocate ( size_t nzval_cnt, size_t block_cnt, bool shared_segment, cell_arena_t * arena = nullptr ) {
           bassert(nzval_cnt!=0 && block_cnt!=0);
 
           size_t aligned_size = 0;
-          if ( shared_segment ) {
+          this->_arena_storage = false;
+          if ( shared_segment && arena ) {
+            size_t diag_cnt = this->i == this->j ? this->width() : 0;
+            this->_gstorage = arena->allocate( (nzval_cnt+diag_cnt)*sizeof(T) + block_cnt*sizeof(block_t) );
+            this->_arena_storage = !this->_gstorage.is_null();
+          }
+
+          if ( this->_arena_storage ) {
+            this->_storage = this->_gstorage.local();
+          }
+          else if ( shared_segment ) {
             if ( this->i == this->j ) {
 #ifdef _ALIGNED_
               aligned_size = std::ceil(( (nzval_cnt+this->width())*sizeof(T) + block_cnt*sizeof(block_t))/alignof(T))*alignof(T);
@@ -2074,7 +2532,7 @@ namespace symPACK{
           }
         }  
 
-        virtual void copy_row_structure( int_t width, blockCell_t<colptr_t,rowind_t, T> * other ) override { 
+        virtual void copy_row_structure( int_t width, blockCell_t<colptr_t,rowind_t, T> * other, cell_arena_t * arena = nullptr ) override { 
           this->i = other->i;
           this->j = other->j;
 
@@ -2083,7 +2541,7 @@ namespace symPACK{
           this->_dims = std::make_tuple(width);
           this->first_col = other->first_col;
 
-          this->allocate(nnz,other->nblocks(),true);
+          this->allocate(nnz,other->nblocks(),true,arena);
           this->initialize(nnz,other->nblocks());
           for ( auto & cur_block: other->blocks() ) {
             this->add_block(cur_block.first_row,other->block_nrows(cur_block));
@@ -2093,7 +2551,7 @@ namespace symPACK{
 
 
 
-        virtual int factorize( TempUpdateBuffers<T> & tmpBuffers) override{
+        virtual int factorize( TempUpdateBuffers<T> & tmpBuffers, const kernels::narrow_limits_t & limits ) override{
           scope_timer(a,blockCellLDL_t::factorize);
 #if defined(_NO_COMPUTATION_)
           return 0;
@@ -2115,7 +2573,7 @@ namespace symPACK{
           return 0;
         }
 
-        virtual int trsm( const blockCellBase_t * pdiag, TempUpdateBuffers<T> & tmpBuffers) override {
+        virtual int trsm( const blockCellBase_t * pdiag, TempUpdateBuffers<T> & tmpBuffers, const kernels::narrow_limits_t & limits ) override {
           scope_timer(a,blockCellLDL_t::trsm);
 #if defined(_NO_COMPUTATION_)
           return 0;
@@ -2162,7 +2620,7 @@ namespace symPACK{
 
 
 
-        virtual int update(  blockCellBase_t * ppivot, blockCellBase_t * pfacing, TempUpdateBuffers<T> & tmpBuffers, T* diag = nullptr) override {
+        virtual int update(  blockCellBase_t * ppivot, blockCellBase_t * pfacing, TempUpdateBuffers<T> & tmpBuffers, const kernels::narrow_limits_t & limits, T* diag = nullptr, update_map_t<rowind_t> * pmap = nullptr) override {
           scope_timer(a,blockCellLDL_t::update);
 #if defined(_NO_COMPUTATION_)
           return 0;
@@ -2222,7 +2680,11 @@ namespace symPACK{
             size_t tgt_offset = 0;
             bool in_place = ( first_pivot_idx == last_pivot_idx );
 
-            if (in_place) { 
+            if ( pmap != nullptr && pmap->computed ) {
+              in_place = pmap->in_place;
+              tgt_offset = pmap->tgt_offset;
+            }
+            else if (in_place) { 
               int tgt_first_upd_blk_idx  = 0;
               for ( ; tgt_first_upd_blk_idx < this->_block_container.size(); tgt_first_upd_blk_idx++ ) {
                 auto & block = this->_block_container[tgt_first_upd_blk_idx];
@@ -2261,6 +2723,13 @@ namespace symPACK{
               }
             }
 
+            if ( pmap != nullptr && !pmap->computed ) {
+              pmap->in_place = in_place;
+              pmap->tgt_offset = tgt_offset;
+              //nothing else to remember for in place updates
+              pmap->computed = in_place;
+            }
+
             int ldbuf = tgt_width;
 
             if (in_place)
@@ -2291,9 +2760,15 @@ namespace symPACK{
             bassert(pivot._bufLDL!=nullptr);
             bufLDL = pivot._bufLDL;
 
-            //Then do -L*W (gemm)
-            blas::Gemm('N','N',tgt_width,src_nrows,src_snode_size,
-                T(-1.0),bufLDL,tgt_width,facing_nzval,src_snode_size,beta,buf,ldbuf);
+            //Then do -L*W (gemm), W is already stored as the packed pivot expected by the fused kernel
+            bool fused = this->use_fused_update(in_place,src_nrows,tgt_width,src_snode_size);
+            if ( fused ) {
+              this->fused_update(pivot,facing,bufLDL,tgt_width,pmap,tmpBuffers);
+            }
+            else {
+              blas::Gemm('N','N',tgt_width,src_nrows,src_snode_size,
+                  T(-1.0),bufLDL,tgt_width,facing_nzval,src_snode_size,beta,buf,ldbuf);
+            }
 
             if ( pivot._own_storage ) {
               if ( pivot.local_pivot.fetch_sub(1)==1) {
@@ -2306,7 +2781,20 @@ namespace symPACK{
 
             //If the GEMM wasn't done in place we need to aggregate the update
             //This is the assembly phase
-            if (!in_place)
+            if ( fused ) {
+              //already accumulated into the target
+            }
+            else if (!in_place && pmap != nullptr) {
+              if ( !pmap->computed ) {
+                SYMPACK_TIMER_SPECIAL_START(UPDATE_SNODE_INDEX_MAP);
+                this->compute_update_map(pivot,facing,*pmap);
+                SYMPACK_TIMER_SPECIAL_STOP(UPDATE_SNODE_INDEX_MAP);
+              }
+              SYMPACK_TIMER_SPECIAL_START(UPDATE_SNODE_ADD);
+              this->scatter_update(*pmap,buf,tgt_width);
+              SYMPACK_TIMER_SPECIAL_STOP(UPDATE_SNODE_ADD);
+            }
+            else if (!in_place)
             {
               {
                 SYMPACK_TIMER_SPECIAL_START(UPDATE_SNODE_INDEX_MAP);
@@ -2525,32 +3013,150 @@ namespace symPACK{
       std::vector< snodeBlock_sptr_t > localBlocks_;
       int nsuper;
       double mem_budget;
-      using cell_key_t = std::pair<uint64_t,uint64_t>;
-      cell_key_t coord2supidx(uint64_t i, uint64_t j) { 
-        cell_key_t val = std::make_pair(i,j);
-        return val;
+
+      //values-only communication plan recorded by DistributeMatrix, it lets
+      //Refactorize redistribute a matrix with the same sparsity pattern
+      struct distribution_plan_t {
+        //number of values sent to each rank
+        std::vector<size_t> send_counts;
+        //position of each local nonzero of the input matrix in the send buffer
+        std::vector<size_t> send_pos;
+        //destination entry of each received value, in receive order
+        std::vector<T*> recv_dest;
+        //hash of the local sparsity pattern of the input matrix
+        uint64_t pattern = 0;
+      };
+      distribution_plan_t dist_plan_;
+      //widths up to which the cell kernels of this matrix use the narrow kernels
+      kernels::narrow_limits_t narrow_limits_ = {0,0,0};
+      static uint64_t pattern_hash_( const DistSparseMatrixGraph & graph ) {
+        //FNV-1a over the local columns
+        uint64_t hash = 1469598103934665603ULL;
+        auto mix = [&hash]( uint64_t value ) { hash = (hash ^ value) * 1099511628211ULL; };
+        mix(graph.GetBaseval());
+        for (auto & ptr: graph.colptr) { mix(ptr); }
+        for (auto & idx: graph.rowind) { mix(idx); }
+        return hash;
+      }
+      //flat cell directory built once after the symbolic factorization:
+      //cells of supernode column j are stored contiguously in
+      //[cell_colptr_[j],cell_colptr_[j+1]), sorted by supernode row.
+      //cells_ owns the cells, the other arrays hold non-owning pointers.
+      std::vector< snodeBlockBase_sptr_t > cells_;
+      //storage of the local cells and of the solve contributions
+      cell_arena_t cell_arena_;
+      cell_arena_t solve_arena_;
+      cell_arena_t * solve_arena() { return this->options_.cell_arena ? &this->solve_arena_ : nullptr; }
+
+      //true if ptr_cell is small enough to be sent to pdest inside its notification.
+      //Cells on the same node are read in place so they are never inlined.
+      bool send_eager_( snodeBlock_t * ptr_cell, int pdest ) const {
+        return ptr_cell->_storage_size <= this->options_.eager_limit
+          && !(this->options_.local_views && upcxx::local_team_contains(pdest));
+      }
+
+      //notification that a cell produced by a FACTOR, TRSM or UPDATE2D_COMP task
+      //is available, payload holds the cell itself if it was sent eagerly
+      struct cell_notification_t {
+        Factorization::op_type op;
+        Int i;
+        Int j;
+        upcxx::global_ptr<char> gptr;
+        size_t storage_size;
+        size_t nnz;
+        size_t nblocks;
+        rowind_t width;
+        SparseTask2D::meta_t meta;
+        bool gpu_block;
+        std::vector<std::size_t> targets;
+        std::vector<char> payload;
+        UPCXX_SERIALIZED_FIELDS(op,i,j,gptr,storage_size,nnz,nblocks,width,meta,gpu_block,targets,payload)
+      };
+      //outgoing notifications, batched per destination rank
+      message_aggregator_t<cell_notification_t> notifications_;
+
+      void notify_cell_( int pdest, Factorization::op_type op, snodeBlock_t * ptr_cell, SparseTask2D::meta_t & meta,
+          scheduling::task_range_t tgt_cells, bool gpu_block = false );
+      void receive_cell_( cell_notification_t & msg );
+      void receive_factor_cell_( cell_notification_t & msg );
+      void receive_trsm_cell_( cell_notification_t & msg );
+      void receive_update_cell_( cell_notification_t & msg );
+      //fills the landing zone of data from the eager payload, or starts its fetch
+      void receive_cell_data_( SparseTask2D::data_t & data, std::vector<char> & payload );
+
+      std::vector< Int > cell_colptr_;
+      std::vector< Int > cell_rowind_;
+      std::vector< blockCellBase_t * > cell_ptrs_;
+      std::vector< snodeBlock_t * > cell_local_ptrs_;
+      //priority of the tasks on each cell of the directory, empty if not used
+      std::vector< double > cell_priority_;
+
+      void build_cell_directory_( std::vector< snodeBlockBase_sptr_t > & cells );
+      //Leaf subtrees whose cells are all owned by one rank (subtree_fast_path). Such a
+      //subtree is factored by a single SUBTREE2D task, its cells get no task of their own.
+      //subtree_owner_[I] is the rank owning the subtree of supernode I, -1 if I is not in
+      //one. It is known by every rank so that no rank sends ops for the subtree cells.
+      std::vector<Int> subtree_owner_;
+      //first and last supernodes of the local subtrees
+      std::vector< std::tuple<Int,Int> > local_subtrees_;
+      //for each local subtree supernode J, the supernodes of the subtree updating it
+      std::vector<Int> subtree_src_ptr_;
+      std::vector<Int> subtree_src_;
+      //node_load is the load of each supernode, the same on every rank
+      void find_local_subtrees_( const std::vector<double> & node_load );
+      //Supernodes mapped 1D (hybrid mapping) whose cells are on a single rank are handled
+      //whole: their FACTOR task also does the trsms of the column, and the updates from
+      //a source supernode into the column are a single UPDATE2D_COMP task, the one on the
+      //diagonal cell. Empty if no supernode is handled whole.
+      std::vector<bool> whole_column_;
+      void find_whole_columns_( const std::vector<bool> & column_1d );
+      bool whole_column( Int J ) const { return !this->whole_column_.empty() && this->whole_column_[J]; }
+      //key of the task updating cell (K,J) from supernode I
+      scheduling::key_t update_key_( Int K, Int J, Int I, Int owner ) const {
+        if ( this->whole_column(J) ) { K = J; }
+        return scheduling::key_t(K,J,I,Factorization::op_type::UPDATE2D_COMP,owner);
+      }
+      //cells produced by a task spanning several cells (local subtree or whole supernode)
+      //that are read by other tasks (directory indices, sorted), and their out dependencies
+      std::vector<Int> export_cells_;
+      scheduling::out_dependencies_t export_deps_;
+      //notifies the tasks reading export_cells_[e]
+      void send_export_( std::size_t e );
+      //splits supernode I in tiles of even width, at most tile_widths[I] (0 keeps it whole),
+      //cutting only along etree chains. Returns the first tile of each supernode
+      std::vector<Int> tileSupernodes_( const std::vector<Int> & tile_widths );
+      //position of a tile among the tiles of the dense top supernodes, -1 for
+      //other supernodes. Empty if there is no dense part.
+      std::vector<Int> dense_root_idx_;
+
+      inline Int cell_index_ (int a, int b) const {
+        if ( b < 0 || b+1 >= (int)this->cell_colptr_.size() ) { return -1; }
+        auto beg = this->cell_rowind_.begin() + this->cell_colptr_[b];
+        auto end = this->cell_rowind_.begin() + this->cell_colptr_[b+1];
+        auto it = std::lower_bound(beg,end,(Int)a);
+        if ( it != end && *it == a ) {
+          return std::distance(this->cell_rowind_.begin(),it);
+        }
+        return -1;
       }
-      std::map<cell_key_t, snodeBlockBase_sptr_t > cells_;
 
-      inline snodeBlockBase_sptr_t pQueryCELL (int a, int b)  { 
-        auto idx = coord2supidx((a),(b)); 
-        auto it = this->cells_.find(idx);
-        if (it != this->cells_.end() ) { 
-          return it->second;
+      inline blockCellBase_t * pQueryCELL (int a, int b)  { 
+        auto idx = cell_index_(a,b);
+        if (idx >= 0 ) { 
+          return this->cell_ptrs_[idx];
         }
         else
           return nullptr;
       }
 
-      inline snodeBlock_sptr_t pQueryCELL2 (int a, int b)  { 
+      inline snodeBlock_t * pQueryCELL2 (int a, int b)  { 
 #ifdef _TIMING_
         gasneti_tick_t start = gasneti_ticks_now();
 #endif
-        auto idx = coord2supidx((a),(b)); 
-        auto it = this->cells_.find(idx);
-        snodeBlock_sptr_t ptr = nullptr;
-        if (it != this->cells_.end() ) { 
-          ptr = std::dynamic_pointer_cast<snodeBlock_t>(it->second);
+        auto idx = cell_index_(a,b);
+        snodeBlock_t * ptr = nullptr;
+        if (idx >= 0 ) { 
+          ptr = this->cell_local_ptrs_[idx];
           bassert ( ptr != nullptr );
         }
 
@@ -2560,7 +3166,7 @@ namespace symPACK{
 
         return ptr;
       }
-      inline snodeBlock_sptr_t pCELL (int a, int b) { return std::static_pointer_cast<snodeBlock_t>(this->cells_[coord2supidx((a),(b))]); }
+      inline snodeBlock_t * pCELL (int a, int b) { return this->cell_local_ptrs_[cell_index_(a,b)]; }
 
 #ifdef _TIMING_
       uint64_t CELL_ticks = 0;
@@ -2590,6 +3196,14 @@ namespace symPACK{
 #else
       TempUpdateBuffers<T> tmpBufs;
 #endif
+      //workspace of the calling thread
+      TempUpdateBuffers<T> & tmp_buffers_() {
+#ifdef SP_THREADS
+        return tmpBufs_th[std::this_thread::get_id()];
+#else
+        return tmpBufs;
+#endif
+      }
 
       std::vector< std::tuple<Int,upcxx::global_ptr<char>> > diag_pointers_;
       const upcxx::global_ptr<char> & find_diag_pointer( int supno ) const {
@@ -2601,13 +3215,47 @@ namespace symPACK{
 
       public:
       using TaskGraph2D = scheduling::task_graph_t3<scheduling::key_t,SparseTask2D >; 
+      //declared before the task graphs: incoming data release their landing zones in the scheduler accounting
+      scheduling::Scheduler2D<SparseTask2D,TaskGraph2D> scheduler;
       std::vector< std::tuple< scheduling::key_t, std::size_t > > task_idx;
       TaskGraph2D task_graph;
+      //relative indices of the UPDATE2D_COMP tasks, indexed like task_graph
+      std::vector< update_map_t<rowind_t> > update_maps_;
 
       std::vector< std::tuple< scheduling::key_t, std::size_t > > task_idx_solve;
       TaskGraph2D task_graph_solve;
 
-      scheduling::Scheduler2D<SparseTask2D,TaskGraph2D> scheduler;
+      void reset_task_graph_( TaskGraph2D & graph );
+      //runs ptask, dispatching on its type to one of the task bodies below
+      void run_task_( SparseTask2D * ptask );
+      //runs count tasks of the same type with the narrow kernels, the workspace is looked up and sized once
+      void run_batch_( SparseTask2D ** tasks, int count );
+      void factor_task_( SparseTask2D * ptask, TempUpdateBuffers<T> & tmpBuf, const kernels::narrow_limits_t & limits );
+      void trsm_task_( SparseTask2D * ptask, TempUpdateBuffers<T> & tmpBuf, const kernels::narrow_limits_t & limits );
+      void dlt_task_( SparseTask2D * ptask );
+      void update_task_( SparseTask2D * ptask, TempUpdateBuffers<T> & tmpBuf, const kernels::narrow_limits_t & limits );
+      //factors a local subtree left-looking, column by column, and sends its exported cells
+      void subtree_task_( SparseTask2D * ptask, TempUpdateBuffers<T> & tmpBuf, const kernels::narrow_limits_t & limits );
+      //pivot and facing cells of an UPDATE2D_COMP task, remote ones are read from its inputs
+      void update_operands_( SparseTask2D * ptask, blockCellBase_t *& ptr_odCell, blockCellBase_t *& ptr_facingCell );
+      void fuc_task_( SparseTask2D * ptask );
+      void buc_task_( SparseTask2D * ptask );
+      //op type of the factorization tasks on supernodes of at most batch_width columns, -1 otherwise
+      int batch_key_( SparseTask2D * ptask ) const;
+      //number of remote contributions received by the FUC and BUC tasks of each supernode
+      std::vector<int> solve_right_deps_;
+      std::vector<int> solve_up_deps_;
+
+      //keys of the remote tasks a local task depends on, per owner, and the
+      //out dependency edge receiving the index of each of them
+      struct task_queries_t {
+        std::vector< std::vector<scheduling::key_t> > keys;
+        std::vector< std::vector<std::size_t> > targets;
+        task_queries_t( int np ):keys(np),targets(np) {}
+      };
+      //each owner looks the keys up in its own index, so no rank stores the keys of the whole graph
+      void resolve_task_queries_( std::vector< std::tuple< scheduling::key_t, std::size_t > > & index, scheduling::out_dependencies_t & deps,
+          task_queries_t & queries );
 
       symPACKMatrix2D();
       ~symPACKMatrix2D();
@@ -2623,6 +3271,9 @@ namespace symPACK{
 
 
       virtual void Factorize() override;
+      //numeric factorization of a matrix with the same sparsity pattern
+      //as the one given to SymbolicFactorization / DistributeMatrix
+      void Refactorize(DistSparseMatrix<T> & pMat);
       virtual void Solve( T * RHS, int nrhs, int rhs_size,  T * Xptr = nullptr ) override;
       virtual void GetSolution(T * B, int nrhs) override;
 
@@ -2655,6 +3306,57 @@ namespace symPACK{
       }
 
       this->mem_budget = this->options_.memory_limit;
+      this->scheduler.lz_pool_.set_capacity(this->options_.landing_zone_pool);
+      this->scheduler.local_views_ = this->options_.local_views;
+      this->scheduler.idle_backoff_ = this->options_.idle_backoff;
+      this->scheduler.batch_size_ = this->options_.batch_size;
+      //batched tasks run the narrow kernels, which stop at narrow_max_width
+      if ( this->options_.batch_width > kernels::narrow_max_width ) {
+        std::stringstream sstr;
+        sstr<<"batch_width "<<this->options_.batch_width<<" is larger than the widest narrow kernel ("<<kernels::narrow_max_width<<")"<<std::endl;
+        throw std::logic_error( sstr.str() );
+      }
+      //the crossover with BLAS is either measured on this machine or given
+      if ( this->options_.narrow_kernels < 0 ) {
+        //measured by the first rank only, so that every rank uses the same kernels
+        //and the rounding of the factor does not depend on timing noise
+        int rank = 0;
+        MPI_Comm_rank(this->options_.MPIcomm,&rank);
+        int widths[3] = {0,0,0};
+        if ( rank == 0 ) {
+          auto limits = kernels::calibrate_narrow<T>();
+          widths[0] = limits.potrf; widths[1] = limits.trsm; widths[2] = limits.update;
+        }
+        MPI_Bcast(widths,3,MPI_INT,0,this->options_.MPIcomm);
+        this->narrow_limits_ = {widths[0],widths[1],widths[2]};
+      }
+      else {
+        int width = std::min((int)this->options_.narrow_kernels,kernels::narrow_max_width);
+        this->narrow_limits_ = {width,width,width};
+      }
+      if ( this->options_.narrow_kernels != 0 ) {
+        auto & limits = this->narrow_limits_;
+        logfileptr->OFS()<<"Narrow kernels up to width: potrf "<<limits.potrf<<", trsm "<<limits.trsm<<", update "<<limits.update<<std::endl;
+      }
+#ifdef SP_THREADS
+      this->scheduler.pin_threads_ = this->options_.pin_threads;
+      this->scheduler.progress_thread_ = this->options_.progress_thread;
+      this->scheduler.nested_flops_ = this->options_.nested_flops;
+#else
+      if ( this->options_.progress_thread ) {
+        logfileptr->OFS()<<"progress_thread requires SP_THREADS, tasks run on the main thread"<<std::endl;
+      }
+      if ( this->options_.nested_flops > 0.0 ) {
+        logfileptr->OFS()<<"nested_flops requires SP_THREADS, kernels are not tiled"<<std::endl;
+      }
+#endif
+      this->notifications_.init(upcxx::rank_n(),[this](int dest, std::vector<cell_notification_t> & batch) {
+          upcxx::rpc_ff( dest, [] (int sp_handle, upcxx::view<cell_notification_t> batch ) {
+              //there is a map between sp_handle and task_graphs
+              auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
+              for ( auto msg: batch ) { matptr->receive_cell_(msg); }
+              }, this->sp_handle, upcxx::make_view(batch.begin(),batch.end()));
+          },this->options_.aggregate_bytes,this->options_.aggregate_ticks);
 
 #ifndef NO_MPI
       this->all_np = 0;
@@ -3031,6 +3733,46 @@ namespace symPACK{
             logfileptr->OFS()<<"Relaxation done"<<std::endl;
           }
 
+          //oversized supernodes are cut in tiles, which splits their cells in
+          //row tiles and column panels with their own owners and tasks
+          this->dense_root_idx_.clear();
+          if (this->options_.tile_width>0 || this->options_.dense_root>0)
+          {
+            Int nsuper = this->Xsuper_.size()-1;
+            std::vector<Int> tile_widths(nsuper+1,this->options_.tile_width);
+            //the wide supernodes at the top of the etree (a wide supernode whose
+            //ancestors are all wide) are essentially dense: they are cut in square
+            //tiles mapped block cyclically over all the ranks
+            std::vector<bool> dense_root(nsuper+1,false);
+            if (this->options_.dense_root>0) {
+              auto supETree = this->ETree_.ToSupernodalETree(this->Xsuper_,this->SupMembership_,this->Order_);
+              for (Int I = nsuper; I >= 1; I--) {
+                Int width = this->Xsuper_[I] - this->Xsuper_[I-1];
+                Int parent = supETree.Parent(I-1);
+                if ( (parent == 0 || dense_root[parent]) && width >= this->options_.dense_root ) {
+                  dense_root[I] = true;
+                  tile_widths[I] = this->options_.dense_tile;
+                }
+              }
+            }
+
+            auto first_tile = this->tileSupernodes_(tile_widths);
+
+            if ( std::find(dense_root.begin(),dense_root.end(),true) != dense_root.end() ) {
+              //tiles are numbered across all the dense supernodes, as in one dense matrix
+              this->dense_root_idx_.assign(this->Xsuper_.size(),-1);
+              Int dense_cnt = 0;
+              for (Int I = 1; I <= nsuper; I++) {
+                if ( !dense_root[I] ) continue;
+                for (Int tile = first_tile[I]; tile < first_tile[I+1]; tile++) {
+                  this->dense_root_idx_[tile] = dense_cnt++;
+                }
+                logfileptr->OFS()<<"Dense root: supernode "<<I<<" cut in "<<first_tile[I+1]-first_tile[I]<<" tiles"<<std::endl;
+              }
+            }
+            logfileptr->OFS()<<"Tiling done"<<std::endl;
+          }
+
           //modify this->np since it cannot be greater than the number of supernodes
           this->dist_np = std::min(this->all_np,this->options_.used_procs(this->Xsuper_.size()-1)); 
           this->np = this->all_np;
@@ -3431,6 +4173,10 @@ namespace symPACK{
           std::vector< ProcGroup > levelGroups_;
           std::vector< Int > groupIdx_;
           std::vector<double> NodeLoad;
+          //load of the supernodes on the path from each supernode to the root
+          std::vector<double> bottom_level;
+          //supernodes whose cells are all mapped to a single rank (1D mapping)
+          std::vector<bool> column_1d(nsuper+1,false);
           std::vector< std::map<Int,double> > LocalCellLoad(this->locXlindx_.size());
 
           std::map< int_t, std::map<int_t,double> > CellLoad;
@@ -3660,6 +4406,14 @@ namespace symPACK{
             bassert( check() );
 #endif
 
+            //the supernodal etree is postordered, parents come after their children
+            bottom_level.assign(supETree.Size()+1,0.0);
+            for (Int I=supETree.Size(); I>= 1;I--) {
+              Int parent = supETree.Parent(I-1);
+              bassert(parent==0 || parent>I);
+              bottom_level[I] = NodeLoad[I] + bottom_level[parent];
+            }
+
             using node_t = struct _node_t { int id; std::vector<_node_t *> children; };
             std::vector<node_t> nodes(nsuper+1);
             node_t * root = &nodes[0];
@@ -3678,6 +4432,16 @@ namespace symPACK{
             }
             numLevels++;
 
+            //deep or narrow supernodes are not worth splitting into cells
+            for (Int I=1; I<=n_; I++) {
+              Int width = this->Xsuper_[I] - this->Xsuper_[I-1];
+              column_1d[I] = (this->options_.hybrid_depth >= 0 && levels[I] >= this->options_.hybrid_depth)
+                || width <= this->options_.hybrid_width;
+            }
+            if ( this->options_.hybrid_depth >= 0 || this->options_.hybrid_width > 0 ) {
+              logfileptr->OFS()<<"Hybrid mapping: "<<std::count(column_1d.begin(),column_1d.end(),true)<<" of "<<n_<<" supernodes mapped 1D"<<std::endl;
+            }
+
             std::vector< ProcGroup > procGroups_;
             groupIdx_.resize(n_+1,0);
             procGroups_.resize(n_+1);
@@ -3787,6 +4551,57 @@ namespace symPACK{
 
 
           snodeBlockBase_sptr_t pLast_cell = nullptr;
+          std::vector< snodeBlockBase_sptr_t > cells;
+
+          //map the cells first so that the arena can hold all the local cells
+          std::vector<Int> cell_owners(recvbuf.size(),-1);
+          //rank holding the whole column of a 1D mapped supernode
+          std::vector<Int> column_owner(nsuper+1,-1);
+          //the grid covers all the ranks: dense_pr is the largest divisor of np up to sqrt(np)
+          Int dense_pr = std::max((Int)1,(Int)std::floor(std::sqrt((double)np)));
+          while ( np % dense_pr != 0 ) { dense_pr--; }
+          Int dense_pc = np / dense_pr;
+          if ( !this->dense_root_idx_.empty() ) {
+            logfileptr->OFS()<<"Dense root grid: "<<dense_pr<<" x "<<dense_pc<<std::endl;
+          }
+          size_t arena_bytes = 0;
+          for (int psend = np-1; psend>=0; --psend) {
+            for (int idxcell = rdispls[psend]; idxcell<rdispls[psend+1]; idxcell++) {
+              auto & cur_cell = recvbuf[idxcell];
+              Int i = std::get<0>(cur_cell);
+              Int j = std::get<1>(cur_cell);
+              if (i!=-1 || j!=-1) {
+                Int p;
+                if ( !this->dense_root_idx_.empty() && this->dense_root_idx_[j] >= 0 ) {
+                  //2D block cyclic layout of the dense root over a dense_pr x dense_pc grid
+                  bassert(this->dense_root_idx_[i] >= 0);
+                  p = (this->dense_root_idx_[i] % dense_pr) * dense_pc + this->dense_root_idx_[j] % dense_pc;
+                  procLoad[p] += CellLoad[j][i];
+                }
+                else if ( column_owner[j] >= 0 ) {
+                  p = column_owner[j];
+                  procLoad[p] += CellLoad[j][i];
+                }
+                else {
+                  p = find_min_proc(i,j);
+                  if ( column_1d[j] ) { column_owner[j] = p; }
+                }
+                cell_owners[idxcell] = p;
+                if ( p == iam ) {
+                  Int iWidth = this->Xsuper_[j] - this->Xsuper_[j-1];
+                  size_t nzval_cnt = std::get<3>(cur_cell) * iWidth;
+                  if (this->options_.decomposition == DecompositionType::LDL && i == j) nzval_cnt += iWidth;
+                  arena_bytes += cell_arena_t::padded( nzval_cnt*sizeof(T) + std::get<2>(cur_cell)*sizeof(typename snodeBlock_t::block_t) );
+                }
+              }
+            }
+          }
+
+          cell_arena_t * arena = nullptr;
+          if ( this->options_.cell_arena ) {
+            this->cell_arena_.reserve(arena_bytes);
+            arena = &this->cell_arena_;
+          }
 
           for (int psend = np-1; psend>=0; --psend) {
             for (int idxcell = rdispls[psend]; idxcell<rdispls[psend+1]; idxcell++) {
@@ -3807,9 +4622,8 @@ namespace symPACK{
               else {
                 Int nBlock = std::get<2>(cur_cell);
                 Int nRows = std::get<3>(cur_cell);
-                auto idx = coord2supidx(i-1,j-1);
                 //j is supernode index
-                auto p = find_min_proc(i,j);
+                auto p = cell_owners[idxcell];
                 Idx fc = this->Xsuper_[j-1];
                 Idx lc = this->Xsuper_[j]-1;
                 Int iWidth = lc-fc+1;
@@ -3819,7 +4633,7 @@ namespace symPACK{
                 snodeBlockBase_sptr_t sptr(nullptr);
                 if ( p == iam ) {
                   if (this->options_.decomposition == DecompositionType::LDL) {
-                    sptr = std::static_pointer_cast<blockCellBase_t>(std::make_shared<snodeBlockLDL_t>(i,j,fc,iWidth,nnz,block_cnt));
+                    sptr = std::static_pointer_cast<blockCellBase_t>(std::make_shared<snodeBlockLDL_t>(i,j,fc,iWidth,nnz,block_cnt,true,arena));
                     this->localBlocks_.push_back(std::static_pointer_cast<snodeBlock_t>(sptr));
                     if ( i == j ) {
                       auto diagcell_ptr = std::dynamic_pointer_cast<snodeBlockLDL_t>(sptr);
@@ -3828,32 +4642,72 @@ namespace symPACK{
                     }
                   }
                   else {
-                    sptr = std::static_pointer_cast<blockCellBase_t>(std::make_shared<snodeBlock_t>(i,j,fc,iWidth,nnz,block_cnt));
+                    sptr = std::static_pointer_cast<blockCellBase_t>(std::make_shared<snodeBlock_t>(i,j,fc,iWidth,nnz,block_cnt,true,arena));
                     this->localBlocks_.push_back(std::static_pointer_cast<snodeBlock_t>(sptr));
                   }
                 }
                 else {
                   sptr = std::make_shared<blockCellBase_t>();
                 }
-                cells_[idx] = sptr;
+                cells.push_back(sptr);
                 sptr->i = i;
                 sptr->j = j;
                 sptr->owner = p;
                 pLast_cell = sptr;
+              }
+            }
+          }
 
-#ifndef _NDEBUG_
-                if ( p ==iam) {
-                  auto & test = CELL(i-1,j-1);
-                }
-                else { 
-                  auto test = pQueryCELL(i-1,j-1);
-                  assert(test);
+          this->build_cell_directory_(cells);
+          this->find_local_subtrees_(NodeLoad);
+          this->find_whole_columns_(column_1d);
+
+          //Critical path priorities: the tasks on a diagonal cell (FACTOR) are followed
+          //by all the work left on the path to the root. The tasks on an off-diagonal
+          //cell (TRSM, updates) by the work left on that cell, then above the supernode.
+          //The dense top of the tree always uses them: all the tasks on a tile column
+          //get the priority of its diagonal tile. The tiles are factored right-looking,
+          //and the updates of the next tile column (lookahead) and the next panel go
+          //ahead of the rest of the trailing updates.
+          this->cell_priority_.clear();
+          if ( this->options_.task_priority == TaskPriorityType::BOTTOM_LEVEL || !this->dense_root_idx_.empty() ) {
+            if ( this->options_.task_priority != TaskPriorityType::BOTTOM_LEVEL ) {
+              logfileptr->OFS()<<"Dense root: bottom level task priorities enabled"<<std::endl;
+            }
+            this->cell_priority_.resize(this->cells_.size(),0.0);
+            for (size_t idx = 0; idx < this->cells_.size(); idx++) {
+              auto & sptr = this->cells_[idx];
+              if ( sptr->i == sptr->j || (!this->dense_root_idx_.empty() && this->dense_root_idx_[sptr->j] >= 0) ) {
+                this->cell_priority_[idx] = bottom_level[sptr->j];
+              }
+              else {
+                double cell_load = 0.0;
+                auto itcol = CellLoad.find(sptr->j);
+                if ( itcol != CellLoad.end() ) {
+                  auto itcell = itcol->second.find(sptr->i);
+                  if ( itcell != itcol->second.end() ) cell_load = itcell->second;
                 }
-#endif
+                this->cell_priority_[idx] = bottom_level[sptr->j] - NodeLoad[sptr->j] + cell_load;
               }
             }
           }
 
+          if ( arena ) {
+            this->cell_arena_.print_stats(logfileptr->OFS(),"Cell arena");
+          }
+
+#ifndef _NDEBUG_
+          for (auto & sptr: cells_) {
+            if ( sptr->owner == iam ) {
+              auto & test = CELL(sptr->i-1,sptr->j-1);
+            }
+            else { 
+              auto test = pQueryCELL(sptr->i-1,sptr->j-1);
+              assert(test);
+            }
+          }
+#endif
+
           std::sort(this->localBlocks_.begin(),this->localBlocks_.end(),[](snodeBlock_sptr_t & a, snodeBlock_sptr_t & b) {
               return a->j < b->j || (a->i < b->i &&  a->j == b->j ) ; 
               });
@@ -3887,6 +4741,9 @@ namespace symPACK{
           std::map<Idx, std::list< SparseTask2D::meta_t> > Updates;
           std::map<Idx, std::list< SparseTask2D::meta_t> > Messages;
           std::vector<int> marker(this->np,0);
+          //no op is generated for the cells of a local subtree, only for the upper tree
+          //tasks reading them
+          auto in_subtree = [this](Int I) { return !this->subtree_owner_.empty() && this->subtree_owner_[I] >= 0; };
 
           Int numLocSnode = this->XsuperDist_[this->iam+1]-this->XsuperDist_[this->iam];
           Int firstSnode = this->XsuperDist_[this->iam];
@@ -3895,13 +4752,15 @@ namespace symPACK{
             Int first_col = this->Xsuper_[I-1];
             Int last_col = this->Xsuper_[I]-1;
 
-            bassert( cells_.find(coord2supidx(I-1,I-1)) != cells_.end() );
+            bassert( pQueryCELL(I-1,I-1) != nullptr );
 
             auto ptr_fcell = pQueryCELL(I-1,I-1);
             Int iOwner = ptr_fcell->owner;
 
             //Create the factor task on the owner
-            Updates[iOwner].push_back(std::make_tuple(I,I,Factorization::op_type::FACTOR,first_col,first_col));
+            if ( !in_subtree(I) ) {
+              Updates[iOwner].push_back(std::make_tuple(I,I,Factorization::op_type::FACTOR,first_col,first_col));
+            }
 
             Ptr lfi = this->locXlindx_[locsupno-1];
             Ptr lli = this->locXlindx_[locsupno]-1;
@@ -3927,15 +4786,19 @@ namespace symPACK{
               auto ptr_fodcell = pQueryCELL(J-1,I-1);
               Int iFODOwner = ptr_fodcell->owner;
 
-              Messages[iOwner].push_back(std::make_tuple(I,I,Factorization::op_type::TRSM_SEND,J_row,J_row));
-              Messages[iFODOwner].push_back(std::make_tuple(I,I,Factorization::op_type::TRSM_RECV,J_row,J_row));
-              Updates[iFODOwner].push_back(std::make_tuple(I,I,Factorization::op_type::TRSM,J_row,J_row));
+              //the FACTOR task of a whole supernode does its trsms
+              if ( !in_subtree(I) && !this->whole_column(I) ) {
+                Messages[iOwner].push_back(std::make_tuple(I,I,Factorization::op_type::TRSM_SEND,J_row,J_row));
+                Messages[iFODOwner].push_back(std::make_tuple(I,I,Factorization::op_type::TRSM_RECV,J_row,J_row));
+                Updates[iFODOwner].push_back(std::make_tuple(I,I,Factorization::op_type::TRSM,J_row,J_row));
+              }
 
               //add the UPDATE_SEND from FODOwner tasks
               for (auto K_row : ancestor_rows) {
                 K = this->SupMembership_[K_row-1];
 
-                if (K>=J) {
+                //a whole supernode J is updated by the task on its diagonal cell
+                if (K>=J && !in_subtree(J) && (K==J || !this->whole_column(J))) {
                   auto ptr_tgtupdcell = pQueryCELL(K-1,J-1);
                   Int iTgtOwner = ptr_tgtupdcell->owner;
                   //TODO update this for non fan-out mapping
@@ -3946,7 +4809,7 @@ namespace symPACK{
                   Messages[iUpdOwner].push_back(std::make_tuple(I,J,Factorization::op_type::UPDATE2D_RECV_OD,K_row,J_row));
                 }
 
-                if (K<=J) {
+                if (K<=J && !in_subtree(K)) {
                   auto ptr_tgtupdcell = pQueryCELL(J-1,K-1);
                   Int iTgtOwner = ptr_tgtupdcell->owner;
                   //TODO update this for non fan-out mapping
@@ -3969,7 +4832,7 @@ namespace symPACK{
               std::set<Int> dlt_sent;
               for (auto K_row : ancestor_rows) {
                 K = this->SupMembership_[K_row-1];
-                if (K>=J) {
+                if (K>=J && !in_subtree(J) && (K==J || !this->whole_column(J))) {
                   auto ptr_tgtupdcell = pQueryCELL(K-1,J-1);
                   Int iTgtOwner = ptr_tgtupdcell->owner;
                   //TODO update this for non fan-out mapping
@@ -4074,6 +4937,7 @@ namespace symPACK{
 
         //do a top down traversal of my local task list and create the computational tasks
         task_graph.clear();
+        task_graph.out_dependencies.clear();
         task_graph.reserve(recvbuf.size());
         task_idx.clear();
         task_idx.reserve(recvbuf.size());
@@ -4108,6 +4972,13 @@ namespace symPACK{
 
           if (ptask!=nullptr) {
             scheduling::key_t key(this->SupMembership_[std::get<4>(cur_op)-1], std::get<1>(cur_op), std::get<0>(cur_op), std::get<2>(cur_op),this->iam);
+            if ( !this->cell_priority_.empty() ) {
+              //the task works on cell (key.cell_J,key.cell_I)
+              Int idx = this->cell_index_(key.cell_J-1,key.cell_I-1);
+              bassert(idx>=0);
+              ptask->priority = this->cell_priority_[idx];
+            }
+            ptask->index = task_graph.size();
             task_graph.push_back( std::unique_ptr<SparseTask2D>(ptask) );
             task_idx.push_back( std::make_tuple(key,task_idx.size()));
           }
@@ -4136,28 +5007,51 @@ namespace symPACK{
 #endif
         }
 
+        //one task per local subtree, no other task depends on it
+        for (auto & subtree: this->local_subtrees_) {
+          Int first = std::get<0>(subtree);
+          Int root = std::get<1>(subtree);
+          auto ptask = new SparseTask2D;
+          ptask->_meta = std::make_tuple(first,root,Factorization::op_type::SUBTREE2D,this->Xsuper_[root-1],this->Xsuper_[root-1]);
+          if ( !this->cell_priority_.empty() ) {
+            ptask->priority = this->cell_priority_[this->cell_index_(root-1,root-1)];
+          }
+          ptask->index = task_graph.size();
+          task_graph.push_back( std::unique_ptr<SparseTask2D>(ptask) );
+        }
+
         //sort task_idx by keys
         std::sort(task_idx.begin(),task_idx.end(),[](std::tuple<scheduling::key_t, std::size_t > &a, std::tuple<scheduling::key_t, std::size_t >&b) { return std::get<0>(a) < std::get<0>(b);});
 
-        MPI_Datatype task_idx_type;
-        MPI_Type_contiguous( sizeof(std::tuple<scheduling::key_t, std::size_t >), MPI_BYTE, &task_idx_type );
-        MPI_Type_commit(&task_idx_type);
-        std::vector< std::tuple<scheduling::key_t, std::size_t > > task_idx_recvbuf;
-        std::vector<int> task_idx_rsizes(this->np,0);
-        std::vector<int> task_idx_rdispls(this->np+1,0);
-
-        int task_idx_size = task_idx.size();
-        MPI_Allgather(&task_idx_size,sizeof(task_idx_size),MPI_BYTE,task_idx_rsizes.data(),sizeof(task_idx_size),MPI_BYTE,this->workcomm_);
-
-        task_idx_rdispls[0] = 0;
-        std::partial_sum(task_idx_rsizes.begin(),task_idx_rsizes.end(),&task_idx_rdispls[1]);
-        task_idx_recvbuf.resize(task_idx_rdispls.back());
-
-        //now communicate the task_idx arrays: allgatherv
-        MPI_Allgatherv(task_idx.data(),task_idx_size,task_idx_type,task_idx_recvbuf.data(),task_idx_rsizes.data(),task_idx_rdispls.data(),task_idx_type,this->workcomm_);
-        MPI_Type_free(&task_idx_type);
-
         auto key_lb_comp = [](const std::tuple<scheduling::key_t, std::size_t > & a, const scheduling::key_t & key) { return std::get<0>(a) < key;};
+
+        //out dependencies on remote tasks are queried from their owner once the whole graph is known
+        task_queries_t queries(this->np);
+        task_queries_t export_queries(this->np);
+        auto add_edge = [&](scheduling::out_dependencies_t & deps, task_queries_t & edge_queries, std::size_t src, Int owner, const scheduling::key_t & key) {
+          if ( owner == this->iam ) {
+            auto task_idx_it = std::lower_bound(task_idx.begin(), task_idx.end(), key, key_lb_comp);
+            bassert(task_idx_it != task_idx.end() && std::get<0>(*task_idx_it) == key);
+            deps.add(src,owner,std::get<1>(*task_idx_it));
+          }
+          else {
+            edge_queries.keys[owner].push_back(key);
+            edge_queries.targets[owner].push_back(deps.add(src,owner,0));
+          }
+        };
+        auto add_out_dependency = [&](SparseTask2D * taskptr, Int owner, const scheduling::key_t & key) {
+          add_edge(this->task_graph.out_dependencies,queries,taskptr->index,owner,key);
+        };
+        //the cells of a local subtree or of a whole supernode have no task of their own:
+        //the edges leaving them are attached to their position in export_cells_
+        this->export_deps_.clear();
+        auto in_subtree = [this](Int I) { return !this->subtree_owner_.empty() && this->subtree_owner_[I] >= 0; };
+        auto add_export_dependency = [&](Int J, Int I, Int owner, const scheduling::key_t & key) {
+          Int idx = this->cell_index_(J-1,I-1);
+          auto it = std::lower_bound(this->export_cells_.begin(),this->export_cells_.end(),idx);
+          bassert(it != this->export_cells_.end() && *it == idx);
+          add_edge(this->export_deps_,export_queries,std::distance(this->export_cells_.begin(),it),owner,key);
+        };
         //now we can process the dependency tasks
 
         for (auto it = recvbuf_dep.begin();it!=recvbuf_dep.end();it++) {
@@ -4184,21 +5078,13 @@ namespace symPACK{
                 bassert(k2 == k1 );
 
                 auto owner = pQueryCELL(J-1,K-1)->owner;
-                auto task_idx_beg = &task_idx_recvbuf[task_idx_rdispls[owner]];
-                auto task_idx_end = task_idx_beg + task_idx_rsizes[owner];
-
-                std::size_t remote_task_idx = 0;
                 scheduling::key_t key(J,K,I,Factorization::op_type::UPDATE2D_COMP,owner);
 
                 if (this->options_.decomposition == DecompositionType::LDL) {
                   key = scheduling::key_t(K,K,I,Factorization::op_type::DLT2D_COMP,owner);
                 }
 
-                auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, (key), key_lb_comp);
-                bassert(task_idx_it != task_idx_end); 
-                remote_task_idx = std::get<1>(*task_idx_it);
-
-                taskptr->out_dependencies[owner].push_back(remote_task_idx);
+                add_out_dependency(taskptr,owner,key);
               }
               break;
             case Factorization::op_type::UPDATE2D_DIAG_RECV:
@@ -4226,7 +5112,7 @@ namespace symPACK{
                   intaskptr->in_local_dependencies_cnt++;
                   auto owner = pQueryCELL(J-1,K-1)->owner;
                   remote_task_idx = std::get<1>(*intask_idx_it);
-                  taskptr->out_dependencies[owner].push_back(remote_task_idx);
+                  this->task_graph.out_dependencies.add(taskptr->index,owner,remote_task_idx);
                 }
                 else {
                   //find the UPDATE2D_COMP and add cell J,I as incoming dependency
@@ -4259,14 +5145,8 @@ namespace symPACK{
 #endif
                 //get index of task TRSM(J,I)
                 auto owner = pQueryCELL(J-1,I-1)->owner;
-                std::size_t remote_task_idx = 0;
                 scheduling::key_t key(J,I,I,Factorization::op_type::TRSM,owner);
-                auto task_idx_beg = &task_idx_recvbuf[task_idx_rdispls[owner]];
-                auto task_idx_end = task_idx_beg + task_idx_rsizes[owner];
-                auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, key, key_lb_comp);
-                bassert(task_idx_it != task_idx_end); 
-                remote_task_idx = std::get<1>(*task_idx_it);
-                taskptr->out_dependencies[owner].push_back(remote_task_idx);
+                add_out_dependency(taskptr,owner,key);
 #ifdef _VERBOSE_
                 logfileptr->OFS()<<"        out dep added to FACTOR"<<" from "<<I<<" to "<<I<<std::endl;
 #endif
@@ -4349,24 +5229,12 @@ namespace symPACK{
 
                 //find the FACTOR or TRSM target task
                 auto owner = pQueryCELL(K-1,J-1)->owner;
-                auto task_idx_beg = &task_idx_recvbuf[task_idx_rdispls[owner]];
-                auto task_idx_end = task_idx_beg + task_idx_rsizes[owner];
-
-                std::size_t remote_task_idx = 0;
                 if (K==J) {
-                  scheduling::key_t key(J,J,J,Factorization::op_type::FACTOR,owner);
-                  auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, (key), key_lb_comp);
-                  bassert(task_idx_it != task_idx_end); 
-                  remote_task_idx = std::get<1>(*task_idx_it);
+                  add_out_dependency(taskptr,owner,scheduling::key_t(J,J,J,Factorization::op_type::FACTOR,owner));
                 }
                 else {
-                  scheduling::key_t key(K,J,J,Factorization::op_type::TRSM,owner);
-                  auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, (key), key_lb_comp);
-                  bassert(task_idx_it != task_idx_end); 
-                  remote_task_idx = std::get<1>(*task_idx_it);
+                  add_out_dependency(taskptr,owner,scheduling::key_t(K,J,J,Factorization::op_type::TRSM,owner));
                 }
-
-                taskptr->out_dependencies[owner].push_back(remote_task_idx);
 #ifdef _VERBOSE_
                 logfileptr->OFS()<<"        out dep added to UPDATE_COMP"<<" from "<<I<<" to "<<J<<std::endl;
 #endif
@@ -4382,7 +5250,7 @@ namespace symPACK{
                 logfileptr->OFS()<<"UPDATE_RECV"<<" from "<<I<<" to "<<K<<" cell ("<<J<<","<<I<<") to cell ("<<J<<","<<K<<")"<<std::endl;
 #endif
                 //find the UPDATE2D_COMP and add cell J,I as incoming dependency
-                auto k1 = scheduling::key_t(J,K,I,Factorization::op_type::UPDATE2D_COMP,this->iam);
+                auto k1 = this->update_key_(J,K,I,this->iam);
                 auto outtask_idx_it = std::lower_bound(task_idx.begin(), task_idx.end(), k1, key_lb_comp);
                 auto taskptr = task_graph[std::get<1>(*outtask_idx_it)].get();
                 bassert(taskptr!=nullptr);
@@ -4406,7 +5274,12 @@ namespace symPACK{
 #ifdef _VERBOSE_
                 logfileptr->OFS()<<"UPDATE_SEND"<<" from "<<I<<" to "<<K<<" cell ("<<J<<","<<I<<") to cell ("<<J<<","<<K<<")"<<std::endl;
 #endif
-                //find the TRSM and add cell J,K as outgoing dependency
+                if ( in_subtree(I) || this->whole_column(I) ) {
+                  auto owner = pQueryCELL(J-1,K-1)->owner;
+                  add_export_dependency(J,I,owner,this->update_key_(J,K,I,owner));
+                  break;
+                }
+                //find the TRSM and add cell J,K as outgoing dependency
                 auto k1 = scheduling::key_t(J,I,I,Factorization::op_type::TRSM,this->iam);
                 auto outtask_idx_it = std::lower_bound(task_idx.begin(), task_idx.end(), k1, key_lb_comp);
                 auto taskptr = task_graph[std::get<1>(*outtask_idx_it)].get();
@@ -4415,16 +5288,7 @@ namespace symPACK{
                 bassert(k2 == k1 );
 
                 auto owner = pQueryCELL(J-1,K-1)->owner;
-                auto task_idx_beg = &task_idx_recvbuf[task_idx_rdispls[owner]];
-                auto task_idx_end = task_idx_beg + task_idx_rsizes[owner];
-
-                std::size_t remote_task_idx = 0;
-                scheduling::key_t key(J,K,I,Factorization::op_type::UPDATE2D_COMP,owner);
-                auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, (key), key_lb_comp);
-                bassert(task_idx_it != task_idx_end); 
-                remote_task_idx = std::get<1>(*task_idx_it);
-
-                taskptr->out_dependencies[owner].push_back(remote_task_idx);
+                add_out_dependency(taskptr,owner,this->update_key_(J,K,I,owner));
 
 #ifdef _VERBOSE_
                 logfileptr->OFS()<<"        out dep added to TRSM"<<" from "<<I<<" to "<<I<<std::endl;
@@ -4438,6 +5302,11 @@ namespace symPACK{
                 logfileptr->OFS()<<"UPDATE_SEND OD"<<" from "<<I<<" to "<<J<<" cell ("<<J<<","<<I<<") to cell ("<<K<<","<<J<<")"<<std::endl;
 #endif
 
+                if ( in_subtree(I) || this->whole_column(I) ) {
+                  auto owner = pQueryCELL(K-1,J-1)->owner;
+                  add_export_dependency(J,I,owner,this->update_key_(K,J,I,owner));
+                  break;
+                }
                 //find the TRSM and add cell K,J as outgoing dependency
                 auto k1 = scheduling::key_t(J,I,I,Factorization::op_type::TRSM,this->iam);
                 auto outtask_idx_it = std::lower_bound(task_idx.begin(), task_idx.end(), k1, key_lb_comp);
@@ -4447,23 +5316,10 @@ namespace symPACK{
                 bassert(k2 == k1 );
 
                 auto owner = pQueryCELL(K-1,J-1)->owner;
-                auto task_idx_beg = &task_idx_recvbuf[task_idx_rdispls[owner]];
-                auto task_idx_end = task_idx_beg + task_idx_rsizes[owner];
-
-                std::size_t remote_task_idx = 0;
-                scheduling::key_t key(K,J,I,Factorization::op_type::UPDATE2D_COMP,owner);
-                auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, (key), key_lb_comp);
-                bassert(task_idx_it != task_idx_end); 
-                remote_task_idx = std::get<1>(*task_idx_it);
-                taskptr->out_dependencies[owner].push_back(remote_task_idx);
+                add_out_dependency(taskptr,owner,this->update_key_(K,J,I,owner));
 
                 if (this->options_.decomposition == DecompositionType::LDL) {
-                  key = scheduling::key_t(J,J,I,Factorization::op_type::DLT2D_COMP,owner);
-                  task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, (key), key_lb_comp);
-                  bassert(task_idx_it != task_idx_end); 
-                  remote_task_idx = std::get<1>(*task_idx_it);
-                  taskptr->out_dependencies[owner].push_back(remote_task_idx);
-
+                  add_out_dependency(taskptr,owner,scheduling::key_t(J,J,I,Factorization::op_type::DLT2D_COMP,owner));
                 }
 
 #ifdef _VERBOSE_
@@ -4479,7 +5335,7 @@ namespace symPACK{
 #endif
 
                 //find the UPDATE2D_COMP and add cell J,I as incoming dependency
-                auto k1 = scheduling::key_t(K,J,I,Factorization::op_type::UPDATE2D_COMP,this->iam);
+                auto k1 = this->update_key_(K,J,I,this->iam);
 
                 auto outtask_idx_it = std::lower_bound(task_idx.begin(), task_idx.end(), k1, key_lb_comp);
                 auto taskptr = task_graph[std::get<1>(*outtask_idx_it)].get();
@@ -4508,7 +5364,7 @@ namespace symPACK{
                   taskptr->in_local_dependencies_cnt++;
                   auto owner = pQueryCELL(K-1,J-1)->owner;
                   std::size_t remote_task_idx = std::get<1>(*outtask_idx_it);
-                  dlttaskptr->out_dependencies[owner].push_back(remote_task_idx);
+                  this->task_graph.out_dependencies.add(dlttaskptr->index,owner,remote_task_idx);
                 }
 
 
@@ -4525,6 +5381,13 @@ namespace symPACK{
           }
         }
 
+        this->resolve_task_queries_(task_idx,this->task_graph.out_dependencies,queries);
+        this->task_graph.out_dependencies.finalize(this->task_graph.size());
+        if ( !this->subtree_owner_.empty() || !this->whole_column_.empty() ) {
+          this->resolve_task_queries_(task_idx,this->export_deps_,export_queries);
+          this->export_deps_.finalize(this->export_cells_.size());
+        }
+
         //fetch the addresses of diagonal cells if necessary (LDL) ?
         //Allgatherv
 
@@ -4555,585 +5418,14 @@ namespace symPACK{
 
 
         scheduler.sp_handle = this->sp_handle;
-        //Now we have our local part of the task graph
+        this->update_maps_.clear();
+        if ( this->options_.reuse_update_maps ) {
+          this->update_maps_.resize(this->task_graph.size());
+        }
+        //Now we have our local part of the task graph, tasks are run by run_task_
         for (auto it = this->task_graph.begin(); it != this->task_graph.end(); it++) {
           auto & ptask = *it;
-          auto meta = &ptask->_meta;
-
-          auto & src_snode = std::get<0>(meta[0]);
-          auto & tgt_snode = std::get<1>(meta[0]);
-          auto & lt_first_row = std::get<3>(meta[0]);
-          auto & facing_row = std::get<4>(meta[0]);
-          auto & type = std::get<2>(meta[0]);
-
-          auto I = src_snode;
-          auto J = tgt_snode;
-          auto K = this->SupMembership_[facing_row-1];
-
-          auto remote_deps = ptask->in_remote_dependencies_cnt;
-          auto local_deps = ptask->in_local_dependencies_cnt;
-
-#ifdef _USE_PROM_AVAIL_
-          ptask->in_avail_prom.require_anonymous(remote_deps);
-          ptask->in_avail_counter = remote_deps;
-#else
-          ptask->in_avail_counter = remote_deps;
-#endif
-#ifdef _USE_PROM_RDY_
-          ptask->in_prom.require_anonymous(local_deps + remote_deps);
-          ptask->in_counter = local_deps + remote_deps;
-#else
-          ptask->in_counter = local_deps + remote_deps;
-#endif
-
-          auto ptr = ptask.get();
-          switch(type) {
-            case Factorization::op_type::FACTOR:
-              {
-                ptask->execute = [this,src_snode,ptr,I,J,K] () {
-                  scope_timer(b,FB_FACTOR_DIAG_TASK);
-                  auto ptask = ptr;
-
-                  auto ptr_diagcell = pQueryCELL2(I-1,I-1);
-                  assert(ptr_diagcell);
-
-#ifdef SP_THREADS
-                  std::thread::id tid = std::this_thread::get_id();
-                  auto & tmpBuf = tmpBufs_th[tid];
-#else
-                  auto & tmpBuf = tmpBufs;
-#endif
-#ifdef _TIMING_
-                  std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
-#endif
-
-                  ptr_diagcell->factorize(tmpBuf);
-#ifdef _TIMING_
-                  std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
-                  comp_fact_ticks += std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
-#endif
-                  //Scan through all dependent tasks, set metadata of dependent tasks, including the global pointer of the dependent task. (which will be on the src processor)
-                  for (auto it = ptask->out_dependencies.begin(); it!=ptask->out_dependencies.end(); it++) {
-                    auto pdest = it->first;
-                    auto & tgt_cells = it->second;
-                    //serialize data once, and list of meta data
-                    //factor is output data so it will not be deleted
-#ifdef CUDA_MODE
-                    bool is_gpu_block = false;
-                    if (pdest != this->iam 
-                        && ptr_diagcell->_nnz*sizeof(T)>symPACK::gpu_block_limit
-                        && tgt_cells.size()>0) {
-                            is_gpu_block = true;
-                    }
-#endif
-                    if ( pdest != this->iam ) {
-                      upcxx::rpc_ff( pdest,
-#ifdef CUDA_MODE
-                          [is_gpu_block]
-#else 
-                          [] 
-#endif
-                          (int sp_handle, upcxx::global_ptr<char> gptr, 
-                               size_t storage_size, 
-                               size_t nnz, size_t nblocks, rowind_t width, 
-                               SparseTask2D::meta_t meta, upcxx::view<std::size_t> target_cells ) { 
-                              //there is a map between sp_handle and task_graphs
-#ifdef _TIMING_
-                              gasneti_tick_t start = gasneti_ticks_now();
-#endif
-                              auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
-                              auto I = std::get<1>(meta);
-                              rowind_t fc = matptr->Xsuper_[I-1];
-
-                              //store pointer & associated metadata somewhere
-                              std::shared_ptr <SparseTask2D::data_t > data;
-                              std::shared_ptr <SparseTask2D::data_t > diag_data;
-
-                              for ( auto & tgt_cell_idx: target_cells) {
-                                  auto taskptr = matptr->task_graph[tgt_cell_idx].get();
-
-                                  if ( std::get<2>(taskptr->_meta) == Factorization::op_type::DLT2D_COMP
-                                      || std::get<2>(taskptr->_meta) == Factorization::op_type::UPDATE2D_COMP
-                                     ) {
-                                      bassert(std::get<2>(taskptr->_meta) == Factorization::op_type::DLT2D_COMP);
-                                      bassert (matptr->options_.decomposition == DecompositionType::LDL);
-                                      if ( !diag_data ) {
-                                        upcxx::global_ptr<char> diag_ptr = matptr->find_diag_pointer( I );
-                                        bassert ( diag_ptr.where() != upcxx::rank_me() );
-                                        diag_data = std::make_shared<SparseTask2D::data_t >();
-                                        diag_data->in_meta = std::make_tuple(I,I,Factorization::op_type::DIAG_ENTRIES,0,0);;
-                                        diag_data->size = (matptr->Xsuper_[I] - matptr->Xsuper_[I-1])*sizeof(T);
-                                        diag_data->remote_gptr = diag_ptr;
-                                      }
-
-                                      taskptr->input_msg.push_back(diag_data);
-                                      diag_data->target_tasks.push_back(taskptr);
-                                      taskptr->avail_dep(1,matptr->scheduler);
-                                  } else {
-                                    
-                                    if ( ! data ) {
-                                      data = std::make_shared<SparseTask2D::data_t >();
-                                      data->in_meta = meta;
-                                      data->size = storage_size;
-                                      data->remote_gptr = gptr;
-#ifdef CUDA_MODE
-                                      if (is_gpu_block) {
-                                        data->is_gpu_block = true;
-                                        data->d_size = nnz;
-                                      }
-#endif
-                                    }
-                                    taskptr->input_msg.push_back(data);
-                                    data->target_tasks.push_back(taskptr);
-                                    taskptr->avail_dep(1,matptr->scheduler);
-                                  }
-                              }
-
-
-                              if ( data ) {
-                                data->on_fetch_future = data->on_fetch_future.then(
-                                    [fc,width,nnz,nblocks,I,matptr,data](SparseTask2D::data_t * pdata) {
-#if not defined(_NO_COMPUTATION_)
-                                    //create snodeBlock_t and store it in the extra_data
-                                    if (matptr->options_.decomposition == DecompositionType::LDL) {
-                                      pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
-                                    }
-                                    else {
-#ifdef CUDA_MODE
-                                      if (data->is_gpu_block) {
-                                        pdata->extra_data = std::shared_ptr<blockCellBase_t>( 
-                                        (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,pdata->d_landing_zone,fc,width,nnz,nblocks) );
-                                      } else {
-                                        pdata->extra_data = std::shared_ptr<blockCellBase_t>( 
-                                        (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
-                                      }
-#else
-                                      pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
-#endif
-                                    }
-#endif
-                                    return upcxx::to_future(pdata);
-                                    });
-#ifdef _EAGER_FETCH_
-                                data->allocate();
-                                data->fetch();
-#endif
-                              }
-
-#ifdef _EAGER_FETCH_
-                              if ( diag_data ) {
-                                diag_data->allocate();
-                                diag_data->fetch();
-                              }
-#endif
-
-#ifdef _TIMING_
-                              matptr->rpc_fact_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
-#endif
-                          }, this->sp_handle, ptr_diagcell->_gstorage, 
-                             ptr_diagcell->_storage_size, ptr_diagcell->nnz(), 
-                             ptr_diagcell->nblocks(), std::get<0>(ptr_diagcell->_dims) ,ptask->_meta, 
-                             upcxx::make_view(tgt_cells.begin(),tgt_cells.end()));                           
-                    }
-                    else {
-                      for ( auto & tgt_cell_idx: tgt_cells ) {
-                        auto taskptr = task_graph[tgt_cell_idx].get();
-                        bassert(taskptr!=nullptr); 
-                        bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::TRSM
-                            ||  std::get<2>(taskptr->_meta) == Factorization::op_type::DLT2D_COMP
-                            ||  std::get<2>(taskptr->_meta) == Factorization::op_type::UPDATE2D_COMP);
-                        //mark the dependency as satisfied
-                        taskptr->satisfy_dep(1,this->scheduler);
-                      }
-                    }
-                  }
-
-#ifdef _TIMING_
-                  deps_fact_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
-#endif
-                  //TODO what do do with the task OR return a future
-                  ptask->executed = true;
-                };
-              }
-              break;
-            case Factorization::op_type::TRSM:
-              {
-
-                ptask->execute = [this,src_snode,tgt_snode,ptr,I,J,K] () {
-                  scope_timer(b,FB_TRSM_TASK);
-                  auto ptask = ptr;
-                  auto ptr_od_cell = pQueryCELL2(K-1,I-1);
-                  assert(ptr_od_cell);
-
-                  bassert( ptr_od_cell->owner == this->iam);
-
-                  {
-#ifdef SP_THREADS
-                    std::thread::id tid = std::this_thread::get_id();
-                    cell_lock<snodeBlock_sptr_t> lock(ptr_od_cell);
-                    auto & tmpBuf = tmpBufs_th[tid];
-#else
-                    auto & tmpBuf = tmpBufs;
-#endif
-
-
-                    //input data is one or 0 (local diagonal block)
-                    bassert(ptask->input_msg.size()<=1);
-                    auto ptr_diagCell = pQueryCELL(I-1,I-1).get(); 
-#if not defined(_NO_COMPUTATION_)
-                    if ( ptr_diagCell->owner != this->iam ) {
-                      ptr_diagCell = (snodeBlock_t*)(ptask->input_msg.begin()->get()->extra_data.get());
-                    }
-                    bassert(ptr_diagCell!=nullptr);
-#endif
-
-#ifdef _TIMING_
-                    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
-#endif
-                    //TODO DEBUG
-                    ptr_od_cell->trsm(ptr_diagCell,tmpBuf);
-#ifdef _TIMING_
-                    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
-                    comp_trsm_ticks += std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
-#endif
-                  }
-#ifdef _TIMING_
-                  start = gasneti_ticks_now();
-#endif
-                  //Iterate thru dependent tasks
-                  for (auto it = ptask->out_dependencies.begin(); it!=ptask->out_dependencies.end(); it++) {
-                    auto pdest = it->first;
-                    auto & tgt_cells = it->second;
-                    //serialize data once, and list of meta data
-                    //factor is output data so it will not be deleted
-                    if ( pdest != this->iam ) {
-                      upcxx::rpc_ff( pdest,
-                          [K,I] (int sp_handle, upcxx::global_ptr<char> gptr, size_t storage_size, 
-                          size_t nnz, size_t nblocks, rowind_t width, SparseTask2D::meta_t meta, upcxx::view<std::size_t> target_cells ) { 
-#ifdef _TIMING_
-                              gasneti_tick_t start = gasneti_ticks_now();
-#endif
-                              //store pointer & associated metadata somewhere
-                              auto data = std::make_shared<SparseTask2D::data_t >();
-                              data->in_meta = meta;
-                              data->size = storage_size;
-                              data->remote_gptr = gptr;
-
-                              //there is a map between sp_handle and task_graphs
-                              auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
-
-                              for ( auto & tgt_cell_idx: target_cells) {
-                              auto taskptr = matptr->task_graph[tgt_cell_idx].get();
-
-                              bassert( std::get<2>(taskptr->_meta)==Factorization::op_type::DLT2D_COMP
-                                  || std::get<2>(taskptr->_meta)==Factorization::op_type::UPDATE2D_COMP);
-
-                              taskptr->input_msg.push_back(data);
-                              data->target_tasks.push_back(taskptr);
-                              taskptr->avail_dep(1,matptr->scheduler);
-                              }
-
-                              auto owner = gptr.where();
-                              rowind_t fc = matptr->Xsuper_[I-1];
-                              data->on_fetch_future = data->on_fetch_future.then(
-                                  [fc,matptr,width,nnz,nblocks,K,I,owner](SparseTask2D::data_t * pdata) {
-#if not defined(_NO_COMPUTATION_)
-                                  //create snodeBlock_t and store it in the extra_data
-                                  if (matptr->options_.decomposition == DecompositionType::LDL) {
-                                    pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(K,I,pdata->landing_zone,fc,width,nnz,nblocks) );
-                                  }
-                                  else {
-                                    pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(K,I,pdata->landing_zone,fc,width,nnz,nblocks) );
-                                  }
-                                  
-                                  pdata->extra_data->owner = owner;
-#endif
-                                  return upcxx::to_future(pdata); 
-                                  }
-                                  );
-#ifdef _EAGER_FETCH_
-                              data->allocate();
-                              data->fetch();
-#endif
-
-#ifdef _TIMING_
-                              matptr->rpc_trsm_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
-#endif
-                          }, this->sp_handle, ptr_od_cell->_gstorage,ptr_od_cell->_storage_size, ptr_od_cell->nnz(),ptr_od_cell->nblocks(), std::get<0>(ptr_od_cell->_dims),ptask->_meta, upcxx::make_view(tgt_cells.begin(),tgt_cells.end())); 
-                    }
-                    else {
-                      std::shared_ptr<SparseTask2D::data_t> diag_data;
-                      if (this->options_.decomposition == DecompositionType::LDL) {
-                        auto ptr_ldl = (snodeBlockLDL_t*)(ptr_od_cell.get());
-                        ptr_ldl->local_pivot = 0;
-                      }
-                      for ( auto & tgt_cell_idx: tgt_cells ) {
-                        auto taskptr = task_graph[tgt_cell_idx].get();
-                        bassert(taskptr!=nullptr); 
-                        bassert( std::get<2>(taskptr->_meta)==Factorization::op_type::DLT2D_COMP
-                            || std::get<2>(taskptr->_meta)==Factorization::op_type::UPDATE2D_COMP);
-
-
-                        if (std::get<2>(taskptr->_meta)==Factorization::op_type::UPDATE2D_COMP &&
-                            this->options_.decomposition == DecompositionType::LDL) {
-                          auto ptr_ldl = (snodeBlockLDL_t*)(ptr_od_cell.get());
-                          //get coordinates of target cell and check if ptr_od_cell is a pivot or a facing cell
-                          auto tJ = std::get<1>(taskptr->_meta);
-                          if ( ptr_ldl->i == tJ ) {
-                            ptr_ldl->local_pivot++;
-                          }
-                        }
-
-                        //mark the dependency as satisfied
-                        taskptr->satisfy_dep(1,this->scheduler);
-                      }
-                    }
-                  }
-
-#ifdef _TIMING_
-                  deps_trsm_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
-#endif
-
-                  ptask->executed = true;
-
-                };
-              }
-              break;
-            case Factorization::op_type::DLT2D_COMP:
-              {
-                ptask->execute = [this,src_snode,ptr,I,J,K] () {
-                  scope_timer(b,FB_DLT2D_TASK);
-                  auto ptask = ptr;
-
-                  bassert(this->options_.decomposition == DecompositionType::LDL);
-
-                  T * diag_ptr = nullptr;
-                  auto ptr_odCell = pQueryCELL(J-1,I-1).get(); 
-                  bool odSet = false;
-                  bool diagSet = false;
-                  for ( auto && msg_ptr: ptask->input_msg ) {
-                    if ( msg_ptr->extra_data ) {
-                      if ( ptr_odCell->owner != this->iam && !odSet) {
-                        odSet = true;
-                        ptr_odCell = (snodeBlock_t*)(msg_ptr->extra_data.get());
-                      }
-#ifndef NDEBUG
-                      else if (odSet && msg_ptr->extra_data.get() != ptr_odCell){
-                        gdb_lock();
-                      }
-#endif
-                    }
-                    else {
-                      diagSet = true;
-                      diag_ptr = (T*)msg_ptr->landing_zone;
-                    }
-                  }
-
-
-
-                  if ( ! diagSet) {
-                    auto ptr_diagCell = pQueryCELL(I-1,I-1).get();
-                    bassert(ptr_diagCell->owner == this->iam);
-                    diag_ptr = (T*)dynamic_cast<snodeBlockLDL_t*>(ptr_diagCell)->GetDiag();
-                  }
-
-                  auto ptr_odCellLDL =  dynamic_cast<snodeBlockLDL_t*>(ptr_odCell);
-
-                  if ( ptr_odCellLDL->owner == this->iam ) {
-                    bassert( ptr_odCellLDL->local_pivot>0 );
-
-                    if ( ptr_odCellLDL->_bufLDL == nullptr ) {
-                      ptr_odCellLDL->computeDLT(diag_ptr);
-                    }
-                  }
-                  else{
-                    if ( ptr_odCellLDL->_bufLDL == nullptr ) {
-                      ptr_odCellLDL->computeDLT(diag_ptr);
-                    }
-                  }
-
-                  //Signal the LOCAL dependencies
-                  for (auto it = ptask->out_dependencies.begin(); it!=ptask->out_dependencies.end(); it++) {
-                    auto pdest = it->first;
-                    auto & tgt_cells = it->second;
-                    //serialize data once, and list of meta data
-                    //factor is output data so it will not be deleted
-                    bassert ( pdest == this->iam );
-                    for ( auto & tgt_cell_idx: tgt_cells ) {
-                      auto taskptr = task_graph[tgt_cell_idx].get();
-                      bassert(taskptr!=nullptr); 
-                      bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::UPDATE2D_COMP);
-                      //mark the dependency as satisfied
-                      taskptr->satisfy_dep(1,this->scheduler);
-                    }
-
-                  }
-                };
-              }
-              break;
-            case Factorization::op_type::UPDATE2D_COMP:
-              {
-
-                ptask->execute = [this,src_snode,ptr,I,J,K] () {
-                  scope_timer(b,FB_UPDATE2D_TASK);
-                  auto ptask = ptr;
-
-                  auto ptr_upd_cell = pQueryCELL2(K-1,J-1);
-                  assert(ptr_upd_cell);
-                  //TODO false for fan-both
-                  bassert(ptr_upd_cell->owner==this->iam);
-
-                  {
-#ifdef SP_THREADS
-                    cell_lock<snodeBlock_sptr_t> lock(ptr_upd_cell);
-#endif
-#ifdef SP_THREADS
-                    std::thread::id tid = std::this_thread::get_id();
-                    auto & tmpBuf = tmpBufs_th[tid];
-#else
-                    auto & tmpBuf = tmpBufs;
-#endif
-
-                    //input data should be at most two
-                    bassert(ptask->input_msg.size()<=2 );
-
-                    auto ptr_odCell = pQueryCELL(J-1,I-1).get(); 
-                    auto ptr_facingCell = pQueryCELL(K-1,I-1).get(); 
-                    bool odSet = false;
-                    bool facingSet = false;
-#if not defined(_NO_COMPUTATION_)
-                    for ( auto && msg_ptr: ptask->input_msg ) {
-                      bassert ( msg_ptr->extra_data != nullptr );
-                      if ( ptr_odCell->owner != this->iam && !odSet) {
-                        odSet = true;
-                        ptr_odCell = (snodeBlock_t*)(msg_ptr->extra_data.get());
-                      }
-                      else if ( ptr_facingCell->owner != this->iam && !facingSet) {
-                        facingSet = true;
-                        ptr_facingCell = (snodeBlock_t*)(msg_ptr->extra_data.get());
-                      }
-                    }
-
-                    bassert( !odSet || ptr_odCell != pQueryCELL(J-1,I-1).get() );
-                    bassert( !facingSet || ptr_facingCell != pQueryCELL(K-1,I-1).get() );
-
-                    bassert( ptr_facingCell->owner == this->iam || ptr_facingCell != pQueryCELL(K-1,I-1).get() );
-                    bassert( ptr_odCell->owner == this->iam || ptr_odCell != pQueryCELL(J-1,I-1).get() );
-
-                    bassert(ptr_odCell!=nullptr);
-                    bassert(ptr_facingCell!=nullptr);
-                    //check that they don't need to be swapped
-                    if ( ptr_facingCell->i < ptr_odCell->i ) {
-                      std::swap(ptr_facingCell, ptr_odCell);
-                    }
-
-#endif
-
-#ifdef _TIMING_
-                    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
-#endif
-
-                    if (this->options_.decomposition == DecompositionType::LDL) {
-#ifndef NDEBUG
-#if not defined(_NO_COMPUTATION_)
-                      auto ptr_od = dynamic_cast<snodeBlockLDL_t*>(ptr_odCell);
-                      auto ptr_facing = dynamic_cast<snodeBlockLDL_t*>(ptr_facingCell);
-                      bassert(ptr_od!=nullptr);
-                      bassert(ptr_facing!=nullptr);
-#endif
-#endif
-                      ptr_upd_cell->update(ptr_odCell,ptr_facingCell,tmpBuf);
-                    }
-                    else {
-                      ptr_upd_cell->update(ptr_odCell,ptr_facingCell,tmpBuf);
-                    }
-
-#ifdef _TIMING_
-                    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
-                    comp_upd_ticks += std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
-#endif
-
-                  }
-
-                  for (auto it = ptask->out_dependencies.begin(); it!=ptask->out_dependencies.end(); it++) {
-                    auto pdest = it->first;
-                    auto & tgt_cells = it->second;
-                    //serialize data once, and list of meta data
-                    //factor is output data so it will not be deleted
-                    if ( pdest != this->iam ) {
-                      upcxx::rpc_ff( pdest, 
-                          [K,J] (int sp_handle, upcxx::global_ptr<char> gptr, size_t storage_size, size_t nnz, size_t nblocks, rowind_t width, SparseTask2D::meta_t meta, upcxx::view<std::size_t> target_cells ) { 
-#ifdef _TIMING_
-                              gasneti_tick_t start = gasneti_ticks_now();
-#endif
-                              //store pointer & associated metadata somewhere
-                              auto data = std::make_shared<SparseTask2D::data_t >();
-                              data->in_meta = meta;
-                              data->size = storage_size;
-                              data->remote_gptr = gptr;
-
-                              //there is a map between sp_handle and task_graphs
-                              auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
-                              for ( auto & tgt_cell_idx: target_cells) {
-                                auto taskptr = matptr->task_graph[tgt_cell_idx].get();
-                                taskptr->input_msg.push_back(data);
-                                data->target_tasks.push_back(taskptr);
-                                taskptr->avail_dep(1,matptr->scheduler);
-                              }
-
-
-                              auto I = std::get<1>(meta);
-                              rowind_t fc = matptr->Xsuper_[I-1];
-                              data->on_fetch_future = data->on_fetch_future.then(
-                                  [fc,width,nnz,nblocks,K,J,matptr](SparseTask2D::data_t * pdata) {
-#if not defined(_NO_COMPUTATION_)
-                                  //create snodeBlock_t and store it in the extra_data
-                                  if (matptr->options_.decomposition == DecompositionType::LDL) {
-                                    pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(K,J,pdata->landing_zone,fc,width,nnz,nblocks) );
-                                  }
-                                  else {
-                                    pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(K,J,pdata->landing_zone,fc,width,nnz,nblocks) );
-                                  }
-#endif
-                                  return upcxx::to_future(pdata);
-                                  }
-                                  );
-                              //TODO check this
-#ifdef _EAGER_FETCH_
-                              data->allocate();
-                              data->fetch();
-#endif
-#ifdef _TIMING_
-                              matptr->rpc_upd_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
-#endif
-                          }, this->sp_handle, ptr_upd_cell->_gstorage, ptr_upd_cell->_storage_size,ptr_upd_cell->nnz(),ptr_upd_cell->nblocks(), std::get<0>(ptr_upd_cell->_dims),ptask->_meta, upcxx::make_view(tgt_cells.begin(),tgt_cells.end())); 
-                    }
-                    else {
-                      for ( auto & tgt_cell_idx: tgt_cells ) {
-                        auto taskptr = task_graph[tgt_cell_idx].get();
-                        bassert(taskptr!=nullptr); 
-                        bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::FACTOR || std::get<2>(taskptr->_meta)==Factorization::op_type::TRSM);
-                        //mark the dependency as satisfied
-                        taskptr->satisfy_dep(1,this->scheduler);
-                      }
-                    }
-                  }
-
-#ifdef _TIMING_
-                  deps_upd_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
-#endif
-
-                  ptask->executed = true;
-                };
-
-              }
-              break;
-            default:
-              {
-                ptask.reset(nullptr);
-              }
-              break;
-          }
+          ptask->init_dependencies();
         }
 
 
@@ -5169,7 +5461,7 @@ namespace symPACK{
             Int first_col = this->Xsuper_[I-1];
             Int last_col = this->Xsuper_[I]-1;
 
-            bassert( cells_.find(coord2supidx(I-1,I-1)) != cells_.end() );
+            bassert( pQueryCELL(I-1,I-1) != nullptr );
 
             auto ptr_fcell = pQueryCELL(I-1,I-1);
             Int iOwner = ptr_fcell->owner;
@@ -5329,6 +5621,7 @@ namespace symPACK{
 
         //do a top down traversal of my local task list and create the computational tasks
         this->task_graph_solve.clear();
+        this->task_graph_solve.out_dependencies.clear();
         this->task_graph_solve.reserve(recvbuf.size());
         task_idx_solve.clear();
         task_idx_solve.reserve(recvbuf.size());
@@ -5361,6 +5654,7 @@ namespace symPACK{
 
           if (ptask!=nullptr) {
             scheduling::key_t key(std::get<0>(cur_op), std::get<1>(cur_op), 0, std::get<2>(cur_op),this->iam);
+            ptask->index = this->task_graph_solve.size();
             this->task_graph_solve.push_back( std::unique_ptr<SparseTask2D>(ptask) );
             task_idx_solve.push_back( std::make_tuple(key,task_idx_solve.size()));
           }
@@ -5372,28 +5666,27 @@ namespace symPACK{
         std::sort(task_idx_solve.begin(),task_idx_solve.end(),[](std::tuple<scheduling::key_t, std::size_t > &a, std::tuple<scheduling::key_t, std::size_t >&b) { return std::get<0>(a) < std::get<0>(b);});
 
 
-        MPI_Datatype task_idx_type;
-        MPI_Type_contiguous( sizeof(std::tuple<scheduling::key_t, std::size_t >), MPI_BYTE, &task_idx_type );
-        MPI_Type_commit(&task_idx_type);
-        std::vector< std::tuple<scheduling::key_t, std::size_t > > task_idx_recvbuf;
-        std::vector<int> task_idx_rsizes(this->np,0);
-        std::vector<int> task_idx_rdispls(this->np+1,0);
-
-        int task_idx_size = task_idx_solve.size();
-        MPI_Allgather(&task_idx_size,sizeof(task_idx_size),MPI_BYTE,task_idx_rsizes.data(),sizeof(task_idx_size),MPI_BYTE,this->workcomm_);
-
-        task_idx_rdispls[0] = 0;
-        std::partial_sum(task_idx_rsizes.begin(),task_idx_rsizes.end(),&task_idx_rdispls[1]);
-        task_idx_recvbuf.resize(task_idx_rdispls.back());
-
-        //now communicate the task_idx arrays: allgatherv
-        MPI_Allgatherv(task_idx_solve.data(),task_idx_size,task_idx_type,task_idx_recvbuf.data(),task_idx_rsizes.data(),task_idx_rdispls.data(),task_idx_type,this->workcomm_);
-        MPI_Type_free(&task_idx_type);
-
         auto key_lb_comp = [](const std::tuple<scheduling::key_t, std::size_t > & a, const scheduling::key_t & key) { return std::get<0>(a) < key;};
 
-        std::vector<int> update_right_cnt(this->nsuper+1,0);
-        std::vector<int> update_up_cnt(this->nsuper+1,0);
+        //out dependencies on remote tasks are queried from their owner once the whole graph is known
+        task_queries_t queries(this->np);
+        auto add_out_dependency = [&](SparseTask2D * taskptr, Int owner, const scheduling::key_t & key) {
+          if ( owner == this->iam ) {
+            auto task_idx_it = std::lower_bound(task_idx_solve.begin(), task_idx_solve.end(), key, key_lb_comp);
+            bassert(task_idx_it != task_idx_solve.end() && std::get<0>(*task_idx_it) == key);
+            this->task_graph_solve.out_dependencies.add(taskptr->index,owner,std::get<1>(*task_idx_it));
+          }
+          else {
+            queries.keys[owner].push_back(key);
+            queries.targets[owner].push_back(this->task_graph_solve.out_dependencies.add(taskptr->index,owner,0));
+          }
+        };
+
+        //number of remote contributions of each FUC and BUC task, used by fuc_task_ and buc_task_
+        auto & update_right_cnt = this->solve_right_deps_;
+        auto & update_up_cnt = this->solve_up_deps_;
+        update_right_cnt.assign(this->nsuper+1,0);
+        update_up_cnt.assign(this->nsuper+1,0);
         //now we can process the dependency tasks
         for (auto it = recvbuf_dep.begin();it!=recvbuf_dep.end();it++) {
           auto & cur_op = (*it);
@@ -5419,19 +5712,12 @@ namespace symPACK{
                 bassert(k2 == k1 );
 
                 auto owner = pQueryCELL(J-1,K-1)->owner;
-                auto task_idx_beg = &task_idx_recvbuf[task_idx_rdispls[owner]];
-                auto task_idx_end = task_idx_beg + task_idx_rsizes[owner];
-
-                std::size_t remote_task_idx = 0;
                 scheduling::key_t key(J,K,0,Factorization::op_type::FUC,owner);
-                auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, (key), key_lb_comp);
-                bassert(task_idx_it != task_idx_end); 
-                remote_task_idx = std::get<1>(*task_idx_it);
 #ifdef _VERBOSE_
                 logfileptr->OFS()<<"FUC_DIAG_SEND"<<" cell ("<<I<<","<<I<<") to cell("<<J<<","<<K<<")"<<std::endl;
 #endif
 
-                taskptr->out_dependencies[owner].push_back(remote_task_idx);
+                add_out_dependency(taskptr,owner,key);
               }
               break;
             case Factorization::op_type::FUC_DIAG_RECV:
@@ -5470,13 +5756,7 @@ namespace symPACK{
                 //get index of task FUC(J,I)
                 auto owner = pQueryCELL(J-1,I-1)->owner;
                 scheduling::key_t key(J,I,0,Factorization::op_type::FUC,owner);
-                auto task_idx_beg = &task_idx_recvbuf[task_idx_rdispls[owner]];
-                auto task_idx_end = task_idx_beg + task_idx_rsizes[owner];
-                auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, key, key_lb_comp);
-                bassert(task_idx_it != task_idx_end); 
-                std::size_t remote_task_idx = std::get<1>(*task_idx_it);
-
-                taskptr->out_dependencies[owner].push_back(remote_task_idx);
+                add_out_dependency(taskptr,owner,key);
               }
               break;
             case Factorization::op_type::FUC_D_RECV:
@@ -5539,20 +5819,12 @@ namespace symPACK{
                 bassert(k2 == k1 );
 
                 auto owner = pQueryCELL(J-1,J-1)->owner;
-                auto task_idx_beg = &task_idx_recvbuf[task_idx_rdispls[owner]];
-                auto task_idx_end = task_idx_beg + task_idx_rsizes[owner];
-
-                std::size_t remote_task_idx = 0;
                 scheduling::key_t key(J,J,0,Factorization::op_type::FUC,owner);
                 Int parent = supETree.Parent(I-1);
                 if (parent == 0 ) {
                   key = scheduling::key_t(J,J,0,Factorization::op_type::BUC,owner);
                 }
-                auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, (key), key_lb_comp);
-                bassert(task_idx_it != task_idx_end); 
-                remote_task_idx = std::get<1>(*task_idx_it);
-
-                taskptr->out_dependencies[owner].push_back(remote_task_idx);
+                add_out_dependency(taskptr,owner,key);
 
                 //check if it's not in it first
                 //this count should also be sent along the rpc
@@ -5599,13 +5871,7 @@ namespace symPACK{
                 auto owner = pQueryCELL(I-1,I-1)->owner;
                 //get index of task BUC(I,I)
                 scheduling::key_t key(I,I,0,Factorization::op_type::BUC,owner);
-                auto task_idx_beg = &task_idx_recvbuf[task_idx_rdispls[owner]];
-                auto task_idx_end = task_idx_beg + task_idx_rsizes[owner];
-                auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, key, key_lb_comp);
-                bassert(task_idx_it != task_idx_end); 
-                std::size_t remote_task_idx = std::get<1>(*task_idx_it);
-
-                taskptr->out_dependencies[owner].push_back(remote_task_idx);
+                add_out_dependency(taskptr,owner,key);
                 update_up_cnt[I]++;
 #ifdef _VERBOSE_
                 logfileptr->OFS()<<"BUC_D_SEND"<<" cell ("<<J<<","<<I<<") to cell("<<I<<","<<I<<")"<<std::endl;
@@ -5631,16 +5897,8 @@ namespace symPACK{
                 bassert(taskptr!=nullptr);
 
                 auto owner = pQueryCELL(J-1,I-1)->owner;
-                auto task_idx_beg = &task_idx_recvbuf[task_idx_rdispls[owner]];
-                auto task_idx_end = task_idx_beg + task_idx_rsizes[owner];
-
-                std::size_t remote_task_idx = 0;
                 scheduling::key_t key(J,I,0,Factorization::op_type::BUC,owner);
-                auto task_idx_it = std::lower_bound(task_idx_beg, task_idx_end, (key), key_lb_comp);
-                bassert(task_idx_it != task_idx_end); 
-                remote_task_idx = std::get<1>(*task_idx_it);
-
-                taskptr->out_dependencies[owner].push_back(remote_task_idx);
+                add_out_dependency(taskptr,owner,key);
               }
               break;
               //WE SHOULD BE RECEIVING ONLY ONCE PER REMOTE PROCESS
@@ -5670,13 +5928,15 @@ namespace symPACK{
           }
         }
 
+        this->resolve_task_queries_(task_idx_solve,this->task_graph_solve.out_dependencies,queries);
+        this->task_graph_solve.out_dependencies.finalize(this->task_graph_solve.size());
 
 #ifdef _VERBOSE_
         logfileptr->OFS()<<update_right_cnt<<std::endl;
         logfileptr->OFS()<<update_up_cnt<<std::endl;
 #endif
 
-        //Now we have our local part of the task graph
+        //Now we have our local part of the task graph, tasks are run by run_task_
         for (auto it = this->task_graph_solve.begin(); it != this->task_graph_solve.end(); it++) {
           auto & ptask = *it;
           auto meta = &ptask->_meta;
@@ -5691,22 +5951,8 @@ namespace symPACK{
           auto I = tgt_snode;
 
           auto remote_deps = ptask->in_remote_dependencies_cnt;
-          auto local_deps = ptask->in_local_dependencies_cnt;
-
-#ifdef _USE_PROM_AVAIL_
-          ptask->in_avail_prom.require_anonymous(remote_deps);
-          ptask->in_avail_counter = remote_deps;
-#else
-          ptask->in_avail_counter = remote_deps;
-#endif
-#ifdef _USE_PROM_RDY_
-          ptask->in_prom.require_anonymous(local_deps + remote_deps);
-          ptask->in_counter = local_deps + remote_deps;
-#else
-          ptask->in_counter = local_deps + remote_deps;
-#endif
+          ptask->init_dependencies();
 
-          auto ptr = ptask.get();
 #ifdef _VERBOSE_
           switch(type) {
             case Factorization::op_type::FUC:
@@ -5723,607 +5969,7 @@ namespace symPACK{
               break;
           }
 #endif
-
-          switch(type) {
-            case Factorization::op_type::FUC:
-              {
-                int dep_cnt = update_right_cnt[J];
-                int upd_diag_cnt = 0;
-                ptask->execute = [this,ptr,I,J,dep_cnt,upd_diag_cnt] () {
-                  scope_timer(b,SOLVE_FUC_TASK);
-                  auto ptask = ptr;
-                  auto ptr_cell = pQueryCELL2(J-1,I-1);
-                  auto & update_right_cnt = this->solve_data.update_right_cnt;
-                  auto & contribs = this->solve_data.contribs;
-                  auto rhs = this->solve_data.rhs;
-     		  auto nrhs = this->solve_data.nrhs;
-                  snodeBlock_sptr_t ptr_contrib = nullptr;
-
-                  if ( I == J ) {
-                    { 
-#ifdef SP_THREADS
-                      cell_lock<std::atomic<bool> > lock_cell(this->solve_data.contribs_lock[J]);
-#endif
-                      {
-                        //Allocate Y(K) with the same structure as L(K,M) where M is the highest anscestor in the Etree this rank owns
-                        auto & contrib_slot = contribs[J];
-                        auto & rptr_contrib = std::get<1>(contrib_slot);
-                        if ( ! rptr_contrib ) {
-                          bassert(update_right_cnt[J] == 0);
-                          rptr_contrib = std::static_pointer_cast<snodeBlock_t>(this->options_.decomposition == DecompositionType::LDL?std::make_shared<snodeBlockLDL_t>():std::make_shared<snodeBlock_t>());
-                          auto ptr_test_cell = pQueryCELL(J-1,J-1);
-                          bassert( ptr_test_cell->owner == this->iam );
-			  //copy ptr_cell test into new rptr_contrib block
-                          rptr_contrib->copy_row_structure(nrhs,(snodeBlock_t*)ptr_test_cell.get());
-                          for (rowind_t row = 0; row< rptr_contrib->total_rows(); ++row) {
-                            rowind_t srcRow = this->Order_.perm[rptr_contrib->first_col-1+row] -1;
-                            for (rowind_t col = 0; col<nrhs;++col) {
-                              rptr_contrib->_nzval[row*nrhs+col] = rhs[srcRow + col*this->iSize_];
-                            }
-      			  }
-                        }
-                        else {
-                          bassert( rptr_contrib->nnz() >0 && rptr_contrib->width()>0);
-                          //Add data from RHS
-                          for (rowind_t row = 0; row< rptr_contrib->total_rows(); ++row) {
-                            rowind_t srcRow = this->Order_.perm[rptr_contrib->first_col-1+row] -1;
-                            for (rowind_t col = 0; col<nrhs;++col) {
-                              rptr_contrib->_nzval[row*nrhs+col] += rhs[srcRow + col*this->iSize_];
-                            }
-                          }	
-                        }
-                        ptr_contrib = rptr_contrib;
-                      }
-
-
-                      //Then accumulate everything coming from children
-                      for ( auto && msg_ptr: ptask->input_msg ) {
-                        if ( msg_ptr->extra_data ) {
-                          auto ptr_rem_contrib = (snodeBlock_t*)(msg_ptr->extra_data.get());
-                          ptr_contrib->forward_update(ptr_rem_contrib);
-                        }
-                      }
-
-                      //compute the product Y(J) -= L(J,J) * Y(J)
-                      ptr_cell->forward_update_contrib(ptr_contrib.get());
-                    } //release the lock here
-
-                    //send the contrib down
-                    for (auto it = ptask->out_dependencies.begin(); it!=ptask->out_dependencies.end(); it++) {
-                      auto pdest = it->first;
-                      auto & tgt_cells = it->second;
-                      //serialize data once, and list of meta data
-                      //diag contrib is output data so it will not be deleted
-                      if ( pdest != this->iam ) {
-                        upcxx::rpc_ff( pdest,  
-                            [] (int sp_handle, upcxx::global_ptr<char> gptr,
-				size_t storage_size, size_t nnz, size_t nblocks, rowind_t width,  SparseTask2D::meta_t meta, 
-				upcxx::view<std::size_t> target_cells ) { 
-                                //there is a map between sp_handle and task_graphs
-                                auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
-                                auto I = std::get<1>(meta);
-                                rowind_t fc = matptr->Xsuper_[I-1];
-
-                                //store pointer & associated metadata somewhere
-                                std::shared_ptr <SparseTask2D::data_t > data;
-
-                                for ( auto & tgt_cell_idx: target_cells) {
-                                auto taskptr = matptr->task_graph_solve[tgt_cell_idx].get();
-                                {
-                                if ( ! data ) {
-                                data = std::make_shared<SparseTask2D::data_t >();
-                                data->in_meta = meta;
-                                data->size = storage_size;
-                                data->remote_gptr = gptr;
-                                }
-
-                                taskptr->input_msg.push_back(data);
-                                data->target_tasks.push_back(taskptr);
-                                taskptr->avail_dep(1,matptr->scheduler);
-                                }
-                                }
-
-
-                                if ( data ) {
-                                  data->on_fetch_future = data->on_fetch_future.then(
-                                      [fc,width,nnz,nblocks,I,matptr](SparseTask2D::data_t * pdata) {
-                                      //create snodeBlock_t and store it in the extra_data
-                                      if (matptr->options_.decomposition == DecompositionType::LDL) {
-                                        pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks,0) );
-                                      }
-                                      else {
-                                        pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
-                                      }
-                                      return upcxx::to_future(pdata);
-                                      });
-                                  //TODO check this
-#ifdef _EAGER_FETCH_
-                                  data->allocate();
-                                  data->fetch();
-#endif
-                                }
-
-
-                            }, this->sp_handle, ptr_contrib->_gstorage, 
-			       ptr_contrib->_storage_size, ptr_contrib->nnz(), ptr_contrib->nblocks(), 
-			       ptr_contrib->width(), ptask->_meta, upcxx::make_view(tgt_cells.begin(),tgt_cells.end())); 
-                      }
-                      else {
-                        for ( auto & tgt_cell_idx: tgt_cells ) {
-                          auto taskptr = task_graph_solve[tgt_cell_idx].get();
-                          bassert(taskptr!=nullptr); 
-                          bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::FUC
-                              || std::get<2>(taskptr->_meta)==Factorization::op_type::BUC);
-                          //mark the dependency as satisfied
-                          taskptr->satisfy_dep(1,this->scheduler);
-                        }
-                      }
-                    }
-                  }
-                  else {
-                    bool deleteContrib = false;
-                    {
-#ifdef SP_THREADS
-                      cell_lock<std::atomic<bool> > lock_cell(this->solve_data.contribs_lock[J]);
-#endif
-                      {
-                        auto & contrib_slot = contribs[J];
-                        auto & counter = std::get<0>(contrib_slot);
-
-                        auto & rptr_contrib = std::get<1>(contrib_slot);
-                        if ( ! rptr_contrib ) {
-                          bassert(update_right_cnt[J] == 0);
-
-                          rptr_contrib = std::static_pointer_cast<snodeBlock_t>(this->options_.decomposition == DecompositionType::LDL?std::make_shared<snodeBlockLDL_t>():std::make_shared<snodeBlock_t>());
-
-                          rowind_t nrows = this->Xsuper_[J] - this->Xsuper_[J-1];
-                          
-			  rptr_contrib = std::static_pointer_cast<snodeBlock_t>(this->options_.decomposition == DecompositionType::LDL?std::make_shared<snodeBlockLDL_t>(J,J,this->Xsuper_[J-1],nrhs,nrows*nrhs,1,nrows,true):std::make_shared<snodeBlock_t>(J,J,this->Xsuper_[J-1],nrhs,nrows*nrhs,1));
-                          
-			  //TODO THIS IS TERRIBLE!!!
-			  rptr_contrib->add_block(this->Xsuper_[J-1],nrows);
-			  //TODO: add cublas scal here
-                          std::fill(rptr_contrib->_nzval,rptr_contrib->_nzval+rptr_contrib->_nnz,T(0));
-     			}
-
-
-                        if (dep_cnt>0) {
-                          auto ptr_test_cell = pQueryCELL(J-1,J-1);
-                          if ( ptr_test_cell->owner != this->iam ) {
-                            deleteContrib = true;
-
-                            if (update_right_cnt[J] == 0 ) {
-                              //TODO THIS IS NOT THREADSAFE, CAN THIS BE DONE BEFORE?
-                              ((*this->solve_data.remoteDeallocCounter))+=dep_cnt;
-                              counter+=dep_cnt;
-                            }
-                            else {
-                            }
-                          }
-                        }
-
-
-                        ptr_contrib = rptr_contrib;
-                      }
-
-
-
-                      bassert(ptask->input_msg.size() <= 1 );
-                      //unpack the part of the solution (y) facing the diagonal block of the supernode
-                      auto ptr_diagContrib = pQueryCELL(I-1,I-1); 
-                      if ( ptr_diagContrib->owner == this->iam ) {
-                        auto tmp2 = contribs.at(I);
-                        auto tmp = contribs[I];
-                        ptr_diagContrib = std::get<1>(contribs[I]);
-                        bassert(ptr_diagContrib != nullptr);
-                      }
-                      else {
-                        if ( ptask->input_msg.size() > 0 ) {
-                          auto msg_ptr = *ptask->input_msg.begin();
-                          bassert ( msg_ptr->extra_data != nullptr );
-                          ptr_diagContrib = (msg_ptr->extra_data);
-                        }
-                      }
-
-                      bassert(I<J);
-                      //compute the product Y(J) -= L(J,I) * Y(I)
-                      ptr_cell->forward_update_contrib(ptr_contrib.get(),ptr_diagContrib.get());
-                    } //release the lock here
-
-                    //send the contrib
-                    for (auto it = ptask->out_dependencies.begin(); it!=ptask->out_dependencies.end(); it++) {
-                      auto pdest = it->first;
-                      auto & tgt_cells = it->second;
-                      //serialize data once, and list of meta data
-                      //factor is output data so it will not be deleted
-                      if ( pdest != this->iam ) {
-                        update_right_cnt[J]++;
-                        if ( dep_cnt == update_right_cnt[J]) {
-                          upcxx::rpc_ff( pdest, 
-                              [dep_cnt,deleteContrib ] (int sp_handle, upcxx::global_ptr<char> gptr, 
-				      			size_t storage_size, size_t nnz, size_t nblocks, rowind_t width, SparseTask2D::meta_t meta, upcxx::view<std::size_t> target_cells ) { 
-                                  //there is a map between sp_handle and task_graphs
-                                  auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
-                                  auto I = std::get<1>(meta);
-                                  auto J = std::get<0>(meta);
-
-
-                                  rowind_t fc = matptr->Xsuper_[I-1];
-
-                                  //store pointer & associated metadata somewhere
-                                  std::shared_ptr <SparseTask2D::data_t > data;
-
-                                  for ( auto & tgt_cell_idx: target_cells) {
-                                  auto taskptr = matptr->task_graph_solve[tgt_cell_idx].get();
-                                  if ( ! data ) {
-                                  data = std::make_shared<SparseTask2D::data_t >();
-                                  data->in_meta = meta;
-                                  data->size = storage_size;
-                                  data->remote_gptr = gptr;
-				  }
-
-
-                                  taskptr->input_msg.push_back(data);
-                                  data->target_tasks.push_back(taskptr);
-                                  taskptr->avail_dep(dep_cnt,matptr->scheduler);
-
-                                  if (dep_cnt>1) {
-                                    taskptr->satisfy_dep(dep_cnt-1,matptr->scheduler);
-                                  }
-                                  }
-
-
-                                  if ( data ) {
-                                    int owner = gptr.where();
-                                    data->on_fetch_future = data->on_fetch_future.then(
-                                        [fc,width,nnz,nblocks,I,matptr,sp_handle,dep_cnt,owner,J,deleteContrib](SparseTask2D::data_t * pdata) {
-                                        //create snodeBlock_t and store it in the extra_data
-                                        if (matptr->options_.decomposition == DecompositionType::LDL) {
-                                        pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks,0) );
-                                        }
-                                        else {
-					pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
-					}
-
-                                        //send a rpc_ff on the owner of the data to signal we have fetched it
-                                        if ( deleteContrib ) {
-                                        matptr->solve_data.deallocRemote(owner,sp_handle,J,dep_cnt);
-                                        }
-
-                                        return upcxx::to_future(pdata);
-                                        });
-                                    //TODO check this
-#ifdef _EAGER_FETCH_
-                                    data->allocate();
-                                    data->fetch();
-#endif
-                                  }
-
-                              }, this->sp_handle, ptr_contrib->_gstorage,
-			 	 ptr_contrib->_storage_size, ptr_contrib->nnz(), ptr_contrib->nblocks(), ptr_contrib->width() ,ptask->_meta, upcxx::make_view(tgt_cells.begin(),tgt_cells.end())); 
-                        }
-                      }
-                      else {
-                        for ( auto & tgt_cell_idx: tgt_cells ) {
-                          auto taskptr = task_graph_solve[tgt_cell_idx].get();
-                          bassert(taskptr!=nullptr); 
-                          bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::FUC);
-                          //mark the dependency as satisfied
-                          taskptr->satisfy_dep(1,this->scheduler);
-                        }
-                      }
-                    }
-                  }
-                  ptask->executed = true;
-
-                };
-
-              }
-              break;
-            case Factorization::op_type::BUC:
-              {
-                int dep_cnt = update_up_cnt[I];
-                ptask->execute = [this,ptr,I,J,dep_cnt] () {
-                  scope_timer(b,SOLVE_BUC_TASK);
-                  auto ptask = ptr;
-                  auto ptr_cell = pQueryCELL2(J-1,I-1);
-
-                  auto & update_up_cnt = this->solve_data.update_up_cnt;
-                  auto & contribs = this->solve_data.contribs;
-                  auto rhs = this->solve_data.rhs;
-                  auto nrhs = this->solve_data.nrhs;
-                  auto ptr_tgtcell = pQueryCELL(I-1,I-1);
-
-                  snodeBlock_sptr_t ptr_contrib = nullptr;
-                  if ( I == J ) {
-                    {
-#ifdef SP_THREADS
-                      cell_lock<std::atomic<bool> > lock_cell(this->solve_data.contribs_lock[I]);
-#endif
-                      {
-                        bassert ( ptr_tgtcell->owner == this->iam ) ;
-                        auto & contrib_slot = contribs[I];
-                        auto & rptr_contrib = std::get<1>(contrib_slot);
-                        bassert( rptr_contrib != nullptr );
-                        bassert( rptr_contrib->nnz() >0 && rptr_contrib->width()>0);
-                        ptr_contrib = rptr_contrib;
-                      }  
-                      if (this->options_.decomposition == DecompositionType::LDL) {
-                        if ( ptr_tgtcell->owner == this->iam ) {
-                          auto & tgt_ldlcell = *std::dynamic_pointer_cast<snodeBlockLDL_t>(ptr_contrib);
-                          if(!tgt_ldlcell.scaled){
-                            ((snodeBlockLDL_t*)ptr_tgtcell.get())->scale_contrib(&tgt_ldlcell);
-                          }
-                        }
-                      }
-                      //Then accumulate everything coming from children
-                      for ( auto && msg_ptr: ptask->input_msg ) {
-                        if ( msg_ptr->extra_data ) {
-                          auto ptr_rem_contrib = (snodeBlock_t*)(msg_ptr->extra_data.get());
-                          ptr_contrib->back_update(ptr_rem_contrib);
-                        }
-                      }
-
-                      //this is a diagonal block update
-                      //this could be implemented as a straight trsm
-                      //compute the product Y(I) -= L(I,I)^T * Y(I)
-                      ptr_cell->back_update_contrib(ptr_contrib.get());
-
-
-#ifndef NDEBUG
-                      if (this->options_.decomposition == DecompositionType::LDL) {
-                        auto tgt_ldlcell = (snodeBlockLDL_t*)(ptr_contrib.get());
-                        bassert(tgt_ldlcell->scaled);
-                      }
-#endif
-                    }
-                    //send the contrib left
-                    for (auto it = ptask->out_dependencies.begin(); it!=ptask->out_dependencies.end(); it++) {
-                      auto pdest = it->first;
-                      auto & tgt_cells = it->second;
-                      //serialize data once, and list of meta data
-                      //diag contrib is output data so it will not be deleted
-                      if ( pdest != this->iam ) {
-                        upcxx::rpc_ff( pdest,  
-                            [ ] (int sp_handle, upcxx::global_ptr<char> gptr, 
-				 size_t storage_size, size_t nnz, size_t nblocks, rowind_t width, SparseTask2D::meta_t meta, upcxx::view<std::size_t> target_cells ) { 
-                                //there is a map between sp_handle and task_graphs
-                                auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
-                                auto I = std::get<1>(meta);
-                                rowind_t fc = matptr->Xsuper_[I-1];
-
-                                //store pointer & associated metadata somewhere
-                                std::shared_ptr <SparseTask2D::data_t > data;
-
-                                for ( auto & tgt_cell_idx: target_cells) {
-                                auto taskptr = matptr->task_graph_solve[tgt_cell_idx].get();
-
-
-                                {
-                                if ( ! data ) {
-                                data = std::make_shared<SparseTask2D::data_t >();
-                                data->in_meta = meta;
-                                data->size = storage_size;
-                                data->remote_gptr = gptr;
-                                }
-
-                                taskptr->input_msg.push_back(data);
-                                data->target_tasks.push_back(taskptr);
-                                taskptr->avail_dep(1,matptr->scheduler);
-                                }
-                                }
-
-
-                                if ( data ) {
-                                  data->on_fetch_future = data->on_fetch_future.then(
-                                      [fc,width,nnz,nblocks,I,matptr](SparseTask2D::data_t * pdata) {
-                                      //create snodeBlock_t and store it in the extra_data
-                                      if (matptr->options_.decomposition == DecompositionType::LDL) {
-                                      pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks,0) );
-                                      }
-                                      else {
-                                      pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
-                                      }
-                                      return upcxx::to_future(pdata); 
-                                      });
-                                  //TODO check this
-#ifdef _EAGER_FETCH_
-                                  data->allocate();
-                                  data->fetch();
-#endif
-                                }
-
-
-                            },  this->sp_handle, ptr_contrib->_gstorage,
-			        ptr_contrib->_storage_size, ptr_contrib->nnz(), ptr_contrib->nblocks(), ptr_contrib->width(), ptask->_meta, upcxx::make_view(tgt_cells.begin(),tgt_cells.end())); 
-                      }
-                      else {
-                        for ( auto & tgt_cell_idx: tgt_cells ) {
-                          auto taskptr = task_graph_solve[tgt_cell_idx].get();
-                          bassert(taskptr!=nullptr); 
-                          bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::BUC);
-                          //mark the dependency as satisfied
-                          taskptr->satisfy_dep(1,this->scheduler);
-                        }
-                      }
-                    }
-                  }
-                  else {
-                    bool deleteContrib = false;
-                    {
-#ifdef SP_THREADS
-                      cell_lock<std::atomic<bool> > lock_cell(this->solve_data.contribs_lock[I]);
-#endif
-                      {
-                        {
-                          auto & contrib_slot = contribs[I];
-                          auto & counter = std::get<0>(contrib_slot);
-                          auto & rptr_contrib = std::get<1>(contrib_slot);
-
-
-                          if ( ptr_tgtcell->owner != this->iam ) {
-                            if (update_up_cnt[I] == 0 ) {
-                              if ( !rptr_contrib ) {
-                                rowind_t nrows = this->Xsuper_[I] - this->Xsuper_[I-1];
-                                rptr_contrib = std::static_pointer_cast<snodeBlock_t>(this->options_.decomposition == DecompositionType::LDL?std::make_shared<snodeBlockLDL_t>(I,I,this->Xsuper_[I-1],nrhs,nrows*nrhs,1,nrows,true):std::make_shared<snodeBlock_t>(I,I,this->Xsuper_[I-1],nrhs,nrows*nrhs,1));
-                                //TODO THIS IS TERRIBLE!!!
-                                rptr_contrib->add_block(this->Xsuper_[I-1],nrows);
-
-                              }
-                              std::fill(rptr_contrib->_nzval,rptr_contrib->_nzval+rptr_contrib->_nnz,T(0));
-
-                            }
-                            else {
-                              bassert(rptr_contrib!=nullptr);
-                            }
-
-                            if (dep_cnt>0) {
-                              deleteContrib = true;
-
-                              if (deleteContrib && update_up_cnt[I] == 0 ) {
-                                //TODO THIS IS NOT THREADSAFE, CAN THIS BE DONE BEFORE?
-                                ((*this->solve_data.remoteDeallocCounter))+=dep_cnt;
-                                counter+=dep_cnt;
-                              }
-                            }
-
-
-                          }
-                          else {
-                            bassert(rptr_contrib!=nullptr);
-                          }
-
-                          bassert( rptr_contrib->nnz() >0 && rptr_contrib->width()>0);
-                          ptr_contrib = rptr_contrib;
-                        }
-
-                        if (this->options_.decomposition == DecompositionType::LDL) {
-                          if ( ptr_tgtcell->owner == this->iam ) {
-                            auto & tgt_ldlcell = *std::dynamic_pointer_cast<snodeBlockLDL_t>(ptr_contrib);
-                            if(!tgt_ldlcell.scaled){
-                              ((snodeBlockLDL_t*)ptr_tgtcell.get())->scale_contrib(&tgt_ldlcell);
-                            }
-                          }
-                        }
-
-
-                        bassert(ptask->input_msg.size() <= 1 );
-                        //unpack the part of the solution (y) facing the diagonal block of the supernode
-                        auto ptr_diagContrib = pQueryCELL(J-1,J-1); 
-                        if ( ptr_diagContrib->owner == this->iam ) {
-                          ptr_diagContrib = std::get<1>(contribs[J]);
-                          bassert(ptr_diagContrib != nullptr);
-
-                          if (this->options_.decomposition == DecompositionType::LDL) {
-                            auto tgt_ldlcell = (snodeBlockLDL_t*)(ptr_diagContrib.get());
-                            bassert(tgt_ldlcell->scaled);
-                          }
-
-
-                        }
-                        else {
-                          if ( ptask->input_msg.size() > 0 ) {
-                            auto msg_ptr = *ptask->input_msg.begin();
-                            bassert ( msg_ptr->extra_data != nullptr );
-                            ptr_diagContrib = (msg_ptr->extra_data);
-                          }
-                        }
-
-
-
-                        //compute the product Y(I) -= L(I,J)^T * Y(J)
-                        ptr_cell->back_update_contrib(ptr_contrib.get(),ptr_diagContrib.get());
-                      }
-                    }
-                    //send the contrib up
-                    for (auto it = ptask->out_dependencies.begin(); it!=ptask->out_dependencies.end(); it++) {
-                      auto pdest = it->first;
-                      auto & tgt_cells = it->second;
-                      //serialize data once, and list of meta data
-                      //factor is output data so it will not be deleted
-                      if ( pdest != this->iam ) {
-                        update_up_cnt[I]++;
-                        if ( dep_cnt == update_up_cnt[I]) {
-                          upcxx::rpc_ff( pdest, 
-                              [ dep_cnt,deleteContrib ] (int sp_handle, upcxx::global_ptr<char> gptr, 
-				      			size_t storage_size, size_t nnz, size_t nblocks, rowind_t width, SparseTask2D::meta_t meta, upcxx::view<std::size_t> target_cells ) { 
-                                  //there is a map between sp_handle and task_graphs
-                                  auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
-                                  auto I = std::get<1>(meta);
-                                  rowind_t fc = matptr->Xsuper_[I-1];
-
-                                  //store pointer & associated metadata somewhere
-                                  std::shared_ptr <SparseTask2D::data_t > data;
-
-                                  for ( auto & tgt_cell_idx: target_cells) {
-                                  auto taskptr = matptr->task_graph_solve[tgt_cell_idx].get();
-                                  if ( ! data ) {
-                                  data = std::make_shared<SparseTask2D::data_t >();
-                                  data->in_meta = meta;
-                                  data->size = storage_size;
-                                  data->remote_gptr = gptr;
-                                  }
-
-
-                                  taskptr->input_msg.push_back(data);
-                                  data->target_tasks.push_back(taskptr);
-                                  taskptr->avail_dep(dep_cnt,matptr->scheduler);
-
-                                  if (dep_cnt>1) {
-                                    taskptr->satisfy_dep(dep_cnt-1,matptr->scheduler);
-                                  }
-                                  }
-
-
-                                  if ( data ) {
-                                    int owner = gptr.where();
-                                    data->on_fetch_future = data->on_fetch_future.then(
-                                        [fc,width,nnz,nblocks,I,matptr,owner,sp_handle,dep_cnt,deleteContrib](SparseTask2D::data_t * pdata) {
-                                        //create snodeBlock_t and store it in the extra_data
-                                        if (matptr->options_.decomposition == DecompositionType::LDL) {
-                                          pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks,0) );
-                                        }
-                                        else {
-                                          pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
-                                        }
-
-
-                                        //send a rpc_ff on the owner of the data to signal we have fetched it
-                                        if ( deleteContrib ) {
-                                        matptr->solve_data.deallocRemote(owner,sp_handle,I,dep_cnt);
-                                        }
-
-                                        return upcxx::to_future(pdata);
-                                        });
-#ifdef _EAGER_FETCH_
-                                    data->allocate();
-                                    data->fetch();
-#endif
-                                  }
-
-                              }, this->sp_handle, ptr_contrib->_gstorage,
-				ptr_contrib->_storage_size, ptr_contrib->nnz(), ptr_contrib->nblocks(), ptr_contrib->width(), ptask->_meta, upcxx::make_view(tgt_cells.begin(),tgt_cells.end())); 
-                        }
-                      }
-                      else {
-                        for ( auto & tgt_cell_idx: tgt_cells ) {
-                          auto taskptr = task_graph_solve[tgt_cell_idx].get();
-                          bassert(taskptr!=nullptr); 
-                          bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::BUC);
-                          //mark the dependency as satisfied
-                          taskptr->satisfy_dep(1,this->scheduler);
-                        }
-                      }
-                    }
-                  }
-                  ptask->executed = true;
-                };
-              }
-              break;
-            default:
-              break;
-          }
-        }
+        }
 
 
         logfileptr->OFS()<<"Solve task graph created"<<std::endl;
@@ -6409,6 +6055,16 @@ namespace symPACK{
 
         std::vector<minType, Mallocator<minType> > sendBuffer(total_send_size);
 
+        //every nonzero is sent as one (col,1,row,val) entry
+        size_t entry_size = IdxToMin+PtrToMin+ (IdxToMin + TToMin);
+        auto & plan = this->dist_plan_;
+        plan.send_counts.assign(this->all_np,0);
+        for (Int p = 0; p < this->all_np; p++) { plan.send_counts[p] = stotcounts[p] / entry_size; }
+        std::vector<size_t> vpositions(this->all_np+1,0);
+        std::partial_sum(plan.send_counts.begin(),plan.send_counts.end(),&vpositions[1]);
+        plan.send_pos.assign(pMat.nzvalLocal.size(),0);
+        plan.pattern = pattern_hash_(pMat.Localg_);
+
         {
           scope_timer(a,symPACKMatrix2D::DistributeMatrix::Serializing);
 
@@ -6438,6 +6094,7 @@ namespace symPACK{
                     Int iDest = ptr_tgt_cell->owner;
 
                     T val = pMat.nzvalLocal[rowidx-1];
+                    plan.send_pos[rowidx-1] = vpositions[iDest]++;
 
                     *((Idx*)&sendBuffer[spositions[iDest]]) = col;
                     spositions[iDest]+=IdxToMin;
@@ -6456,6 +6113,7 @@ namespace symPACK{
                     //add the pair (col,row) to processor owning column row
 
                     T val = pMat.nzvalLocal[rowidx-1];
+                    plan.send_pos[rowidx-1] = vpositions[iDestJ]++;
 
                     *((Idx*)&sendBuffer[spositions[iDestJ]]) = row;
                     spositions[iDestJ]+=IdxToMin;
@@ -6500,6 +6158,8 @@ namespace symPACK{
         {
           scope_timer(a,symPACKMatrix2D::DistributeMatrix::Deserializing);
           size_t head = 0;
+          size_t vhead = 0;
+          plan.recv_dest.assign(total_recv_size / entry_size,nullptr);
 
           while (head < total_recv_size)
           { 
@@ -6530,50 +6190,1712 @@ namespace symPACK{
               apply_permutation(&nzvalA[colbeg-1],&nzvalA[colend-1]+1,lperm);
               Idx firstRow = rowind[colbeg-1];
 
-              for (Ptr rowidx = colbeg; rowidx<=colend; ++rowidx) {
-                Idx row = rowind[rowidx-1];
+              for (Ptr rowidx = colbeg; rowidx<=colend; ++rowidx) {
+                Idx row = rowind[rowidx-1];
+
+                Int J = this->SupMembership_[row-1];
+
+                auto ptr_tgt_cell = pQueryCELL(J-1,I-1);
+                assert(ptr_tgt_cell);
+
+                auto & tgt_cell =CELL(J-1,I-1);
+                bassert(this->iam == tgt_cell.owner);
+                bassert(tgt_cell.i==J && tgt_cell.j==I);
+
+                bool found = false;
+                for (auto & block: tgt_cell.blocks()) {
+                  //Match found if row between first and last row of block
+                  if ( block.first_row <= row && row < block.first_row + tgt_cell.block_nrows(block) ) {
+                    //Offset is block offset + row index in block & number of cols in tgt_cell
+                    auto offset = block.offset + (row - block.first_row)*tgt_cell.width() + (col-fc);
+                    tgt_cell._nzval[offset] = nzvalA[rowidx-1];
+                    plan.recv_dest[vhead + lperm[rowidx-1]] = &tgt_cell._nzval[offset];
+                    found = true;
+                    break;
+
+                  }  
+                }
+
+                bassert(found);
+
+              }
+              
+            }
+            vhead += nrows;
+          }
+          bassert(vhead == plan.recv_dest.size());
+
+        }
+        
+
+      }
+
+
+
+
+
+
+
+    } 
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::build_cell_directory_( std::vector< snodeBlockBase_sptr_t > & cells ) {
+      //sort cells by supernode column then supernode row
+      std::sort(cells.begin(),cells.end(),[](const snodeBlockBase_sptr_t & a, const snodeBlockBase_sptr_t & b) {
+          return a->j < b->j || (a->j == b->j && a->i < b->i);
+          });
+
+      this->cell_colptr_.assign(this->nsuper+1,0);
+      this->cell_rowind_.resize(cells.size());
+      this->cell_ptrs_.resize(cells.size());
+      this->cell_local_ptrs_.resize(cells.size());
+
+      for (size_t idx = 0; idx < cells.size(); idx++) {
+        auto & sptr = cells[idx];
+        bassert(sptr->j>=1 && sptr->j<=this->nsuper);
+        this->cell_colptr_[sptr->j]++;
+        this->cell_rowind_[idx] = sptr->i-1;
+        this->cell_ptrs_[idx] = sptr.get();
+        //only cells owned by this rank are actual snodeBlock_t
+        this->cell_local_ptrs_[idx] = sptr->owner == this->iam ? static_cast<snodeBlock_t*>(sptr.get()) : nullptr;
+      }
+      std::partial_sum(this->cell_colptr_.begin(),this->cell_colptr_.end(),this->cell_colptr_.begin());
+
+      this->cells_.swap(cells);
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    std::vector<Int> symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::tileSupernodes_( const std::vector<Int> & tile_widths ) {
+      //A cut after column c keeps the relaxed structure (and cc) valid only if the
+      //columns c to the last column of the supernode form a chain of the etree,
+      //each tile then being the parent of the previous one. Relaxation can merge
+      //sibling subtrees whose columns are not a chain: they stay in the first tile.
+      std::vector<Int> xsuper;
+      std::vector<Int> first_tile(this->Xsuper_.size()+1,0);
+      xsuper.reserve(this->Xsuper_.size());
+      xsuper.push_back(this->Xsuper_[0]);
+      Int restricted = 0;
+      for (size_t I = 1; I < this->Xsuper_.size(); I++) {
+        first_tile[I] = xsuper.size();
+        Int fc = this->Xsuper_[I-1];
+        Int lc = this->Xsuper_[I]-1;
+        Int width = lc - fc + 1;
+        Int tile_width = tile_widths[I] > 0 ? tile_widths[I] : width;
+        Int ntiles = (width + tile_width - 1) / tile_width;
+        if ( ntiles > 1 ) {
+          //first column of the chain ending at lc
+          Int chain_fc = lc;
+          while ( chain_fc > fc && this->ETree_.PostParent(chain_fc-2) == chain_fc ) { chain_fc--; }
+          if ( chain_fc > fc ) { restricted++; }
+          for (Int tile = 1; tile < ntiles; tile++) {
+            Int next_fc = fc + (Int)(((int64_t)width*tile)/ntiles);
+            if ( next_fc-1 >= chain_fc ) { xsuper.push_back(next_fc); }
+          }
+        }
+        xsuper.push_back(lc+1);
+      }
+
+      //every cut must be inside a chain
+      for (size_t I = 1; I+1 < xsuper.size(); I++) {
+        Int lc = xsuper[I]-1;
+        bool cut = std::binary_search(this->Xsuper_.begin(),this->Xsuper_.end(),xsuper[I]) == false;
+        if ( cut && this->ETree_.PostParent(lc-1) != lc+1 ) {
+          throw std::logic_error("tileSupernodes_: tile boundary outside of an etree chain");
+        }
+      }
+
+      for (size_t I = 1; I < xsuper.size(); I++) {
+        for (Int col = xsuper[I-1]; col < xsuper[I]; col++) {
+          this->SupMembership_[col-1] = I;
+        }
+      }
+      first_tile.back() = xsuper.size();
+      logfileptr->OFS()<<"Tiling: "<<this->Xsuper_.size()-1<<" supernodes cut in "<<xsuper.size()-1<<" tiles ("
+        <<restricted<<" supernodes only cut along their etree chain)"<<std::endl;
+      this->Xsuper_.swap(xsuper);
+      return first_tile;
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::find_local_subtrees_( const std::vector<double> & node_load ) {
+      this->subtree_owner_.clear();
+      this->local_subtrees_.clear();
+      this->subtree_src_ptr_.clear();
+      this->subtree_src_.clear();
+      this->export_cells_.clear();
+      if ( !this->options_.subtree_fast_path || this->options_.decomposition == DecompositionType::LDL ) return;
+
+      //owner of all the cells of each column, -1 if they are spread over several ranks
+      std::vector<Int> column_owner(this->nsuper+1,-1);
+      for (Int I = 1; I <= this->nsuper; I++) {
+        Int owner = this->cell_ptrs_[this->cell_colptr_[I-1]]->owner;
+        for (Int idx = this->cell_colptr_[I-1]; idx < this->cell_colptr_[I] && owner >= 0; idx++) {
+          if ( this->cell_ptrs_[idx]->owner != owner ) owner = -1;
+        }
+        column_owner[I] = owner;
+      }
+
+      //a subtree is a single task: it is kept small enough for each compute
+      //thread of each rank to get several of them
+      double max_load = std::accumulate(node_load.begin(),node_load.end(),0.0)
+        / ( (double)this->np * std::max(1,Multithreading::NumThread) * 4.0 );
+
+      //supernodes are postordered: the subtree of I is [first[I],I]
+      auto supETree = this->ETree_.ToSupernodalETree(this->Xsuper_,this->SupMembership_,this->Order_);
+      std::vector<double> subtree_load(node_load);
+      std::vector<Int> first(this->nsuper+1);
+      std::iota(first.begin(),first.end(),0);
+      this->subtree_owner_ = column_owner;
+      for (Int I = 1; I <= this->nsuper; I++) {
+        if ( subtree_load[I] > max_load ) this->subtree_owner_[I] = -1;
+        Int parent = supETree.Parent(I-1);
+        if ( parent != 0 ) {
+          subtree_load[parent] += subtree_load[I];
+          first[parent] = std::min(first[parent],first[I]);
+          if ( this->subtree_owner_[I] != column_owner[parent] ) this->subtree_owner_[parent] = -1;
+        }
+      }
+
+      Int local_cnt = 0;
+      for (Int I = 1; I <= this->nsuper; I++) {
+        if ( this->subtree_owner_[I] != this->iam ) continue;
+        local_cnt++;
+        Int parent = supETree.Parent(I-1);
+        if ( parent == 0 || this->subtree_owner_[parent] < 0 ) {
+          this->local_subtrees_.push_back(std::make_tuple(first[I],I));
+        }
+      }
+
+      //left-looking lists: J is updated by the supernodes of its subtree having a cell on row J.
+      //The other off-diagonal cells of a subtree are read by the upper tree.
+      this->subtree_src_ptr_.assign(this->nsuper+1,0);
+      for (Int I = 1; I <= this->nsuper; I++) {
+        if ( this->subtree_owner_[I] != this->iam ) continue;
+        for (Int idx = this->cell_colptr_[I-1]+1; idx < this->cell_colptr_[I]; idx++) {
+          Int J = this->cell_rowind_[idx]+1;
+          if ( this->subtree_owner_[J] == this->iam ) {
+            this->subtree_src_ptr_[J]++;
+          }
+          else {
+            this->export_cells_.push_back(idx);
+          }
+        }
+      }
+      std::partial_sum(this->subtree_src_ptr_.begin(),this->subtree_src_ptr_.end(),this->subtree_src_ptr_.begin());
+      this->subtree_src_.resize(this->subtree_src_ptr_.back());
+      std::vector<Int> pos(this->subtree_src_ptr_.begin(),this->subtree_src_ptr_.end()-1);
+      for (Int I = 1; I <= this->nsuper; I++) {
+        if ( this->subtree_owner_[I] != this->iam ) continue;
+        for (Int idx = this->cell_colptr_[I-1]+1; idx < this->cell_colptr_[I]; idx++) {
+          Int J = this->cell_rowind_[idx]+1;
+          if ( this->subtree_owner_[J] == this->iam ) { this->subtree_src_[pos[J-1]++] = I; }
+        }
+      }
+
+      logfileptr->OFS()<<"Subtree fast path: "<<this->local_subtrees_.size()<<" subtrees of "<<local_cnt<<" supernodes, "
+        <<this->export_cells_.size()<<" cells read by the upper tree"<<std::endl;
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::find_whole_columns_( const std::vector<bool> & column_1d ) {
+      this->whole_column_.clear();
+      if ( this->options_.decomposition == DecompositionType::LDL
+          || std::find(column_1d.begin(),column_1d.end(),true) == column_1d.end() ) return;
+
+      this->whole_column_.assign(this->nsuper+1,false);
+      Int whole_cnt = 0;
+      for (Int J = 1; J <= this->nsuper; J++) {
+        if ( !column_1d[J] || (!this->subtree_owner_.empty() && this->subtree_owner_[J] >= 0) ) continue;
+        if ( !this->dense_root_idx_.empty() && this->dense_root_idx_[J] >= 0 ) continue;
+        Int owner = this->cell_ptrs_[this->cell_colptr_[J-1]]->owner;
+        bool whole = true;
+        for (Int idx = this->cell_colptr_[J-1]; idx < this->cell_colptr_[J] && whole; idx++) {
+          whole = this->cell_ptrs_[idx]->owner == owner;
+        }
+        this->whole_column_[J] = whole;
+        if ( !whole ) continue;
+        whole_cnt++;
+        //every off-diagonal cell is read by the updates of an ancestor
+        if ( owner == this->iam ) {
+          for (Int idx = this->cell_colptr_[J-1]+1; idx < this->cell_colptr_[J]; idx++) {
+            this->export_cells_.push_back(idx);
+          }
+        }
+      }
+      std::sort(this->export_cells_.begin(),this->export_cells_.end());
+      logfileptr->OFS()<<"Whole supernode tasks: "<<whole_cnt<<" of "<<this->nsuper<<" supernodes"<<std::endl;
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::reset_task_graph_( TaskGraph2D & graph ) {
+      for (auto it = graph.begin(); it != graph.end(); it++) {
+        auto & ptask = *it;
+        ptask->reset();
+        ptask->init_dependencies();
+      }
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::Refactorize( DistSparseMatrix<T> & pMat ) {
+      scope_timer(a,symPACKMatrix2D::Refactorize);
+      auto & plan = this->dist_plan_;
+      //the plan is only valid for the sparsity pattern given to DistributeMatrix,
+      //the ranks agree on it before any of them enters the redistribution
+      int mismatch = plan.send_pos.size() != pMat.nzvalLocal.size() || plan.pattern != pattern_hash_(pMat.Localg_);
+      MPI_Allreduce(MPI_IN_PLACE,&mismatch,1,MPI_INT,MPI_MAX,this->fullcomm_);
+      if ( mismatch ) {
+        throw std::runtime_error("Refactorize: the sparsity pattern differs from the one given to DistributeMatrix");
+      }
+
+      //remote ranks may still be reading our cells from the previous factorization/solve
+      upcxx::barrier();
+
+      {
+        scope_timer(a,symPACKMatrix2D::Refactorize::Reset);
+        for (auto & ptr_cell: this->localBlocks_) {
+          std::fill(ptr_cell->_nzval,ptr_cell->_nzval+ptr_cell->_nnz,T(0));
+          if (this->options_.decomposition == DecompositionType::LDL) {
+            auto ptr_ldl = (snodeBlockLDL_t*)(ptr_cell.get());
+            if ( ptr_ldl->_bufLDL ) {
+              delete [] ptr_ldl->_bufLDL;
+              ptr_ldl->_bufLDL = nullptr;
+            }
+            ptr_ldl->local_pivot = 0;
+          }
+        }
+        //Factorize and Solve re-arm their task graphs
+      }
+
+      {
+        scope_timer(a,symPACKMatrix2D::Refactorize::Redistribute);
+        std::vector<size_t> spositions(this->all_np+1,0);
+        std::partial_sum(plan.send_counts.begin(),plan.send_counts.end(),&spositions[1]);
+
+        std::vector<T, Mallocator<T> > sendBuffer(spositions.back());
+        for (size_t k = 0; k < plan.send_pos.size(); k++) {
+          sendBuffer[plan.send_pos[k]] = pMat.nzvalLocal[k];
+        }
+
+        std::vector<T, Mallocator<T> > recvBuffer;
+        std::function<void(std::vector<T, Mallocator<T> >&,size_t)> resize_lambda =
+          [](std::vector<T, Mallocator<T> >& container, size_t sz) {
+            container.resize(sz);
+          };
+
+        MPI_Datatype type;
+        MPI_Type_contiguous( sizeof(T), MPI_BYTE, &type );
+        MPI_Type_commit(&type);
+
+        mpi::Alltoallv(sendBuffer, &plan.send_counts[0], &spositions[0], type ,
+            recvBuffer,this->fullcomm_, resize_lambda);
+
+        MPI_Type_free(&type);
+
+        bassert(recvBuffer.size() == plan.recv_dest.size());
+        for (size_t k = 0; k < recvBuffer.size(); k++) {
+          *plan.recv_dest[k] = recvBuffer[k];
+        }
+      }
+
+      this->Factorize();
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::run_task_( SparseTask2D * ptask ) {
+      switch ( std::get<2>(ptask->_meta) ) {
+        case Factorization::op_type::FACTOR: this->factor_task_(ptask,this->tmp_buffers_(),this->narrow_limits_); break;
+        case Factorization::op_type::TRSM: this->trsm_task_(ptask,this->tmp_buffers_(),this->narrow_limits_); break;
+        case Factorization::op_type::DLT2D_COMP: this->dlt_task_(ptask); break;
+        case Factorization::op_type::UPDATE2D_COMP: this->update_task_(ptask,this->tmp_buffers_(),this->narrow_limits_); break;
+        case Factorization::op_type::SUBTREE2D: this->subtree_task_(ptask,this->tmp_buffers_(),this->narrow_limits_); break;
+        case Factorization::op_type::FUC: this->fuc_task_(ptask); break;
+        case Factorization::op_type::BUC: this->buc_task_(ptask); break;
+        default: bassert(false); break;
+      }
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::run_batch_( SparseTask2D ** tasks, int count ) {
+      auto & tmpBuf = this->tmp_buffers_();
+      //the source supernodes of the batch are at most batch_width <= narrow_max_width wide:
+      //they all take the width specialized kernels, whatever -narrow says
+      int width = this->options_.batch_width;
+      kernels::narrow_limits_t limits = { std::max(this->narrow_limits_.potrf,width),
+        std::max(this->narrow_limits_.trsm,width), std::max(this->narrow_limits_.update,width) };
+      switch ( std::get<2>(tasks[0]->_meta) ) {
+        case Factorization::op_type::FACTOR:
+          for (int t = 0; t < count; t++) { this->factor_task_(tasks[t],tmpBuf,limits); }
+          break;
+        case Factorization::op_type::TRSM:
+          for (int t = 0; t < count; t++) { this->trsm_task_(tasks[t],tmpBuf,limits); }
+          break;
+        case Factorization::op_type::UPDATE2D_COMP:
+          {
+#if not defined(_NO_COMPUTATION_)
+            //one allocation for the largest temporary update of the batch
+            size_t size = 0;
+            for (int t = 0; t < count; t++) {
+              //the kernels size the workspace of a whole supernode update themselves
+              if ( this->whole_column(std::get<1>(tasks[t]->_meta)) ) continue;
+              blockCellBase_t * ptr_odCell = nullptr;
+              blockCellBase_t * ptr_facingCell = nullptr;
+              this->update_operands_(tasks[t],ptr_odCell,ptr_facingCell);
+              auto ptr_od = (snodeBlock_t*)ptr_odCell;
+              size_t nrows = ptr_od->total_rows();
+              size = std::max(size, nrows*((snodeBlock_t*)ptr_facingCell)->total_rows() + nrows*std::get<0>(ptr_od->_dims));
+            }
+            tmpBuf.tmpBuf.reserve(size);
+#endif
+            for (int t = 0; t < count; t++) { this->update_task_(tasks[t],tmpBuf,limits); }
+          }
+          break;
+        default:
+          for (int t = 0; t < count; t++) { this->run_task_(tasks[t]); }
+          break;
+      }
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    int symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::batch_key_( SparseTask2D * ptask ) const {
+      auto type = std::get<2>(ptask->_meta);
+      if ( type != Factorization::op_type::FACTOR && type != Factorization::op_type::TRSM
+          && type != Factorization::op_type::UPDATE2D_COMP ) { return -1; }
+      //the source supernode sets the inner dimension of the kernels
+      auto I = std::get<0>(ptask->_meta);
+      Int width = this->Xsuper_[I] - this->Xsuper_[I-1];
+      return width <= this->options_.batch_width ? (int)type : -1;
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::factor_task_( SparseTask2D * ptask, TempUpdateBuffers<T> & tmpBuf, const kernels::narrow_limits_t & limits ) {
+      scope_timer(b,FB_FACTOR_DIAG_TASK);
+      auto I = std::get<0>(ptask->_meta);
+
+      auto ptr_diagcell = pQueryCELL2(I-1,I-1);
+      assert(ptr_diagcell);
+
+#ifdef _TIMING_
+      std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+#endif
+
+      ptr_diagcell->factorize(tmpBuf,limits);
+#ifdef _TIMING_
+      std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+      comp_fact_ticks += std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+#endif
+      if ( this->whole_column(I) ) {
+        //the trsms of the column, then each cell goes to the updates reading it
+        auto export_it = std::lower_bound(this->export_cells_.begin(),this->export_cells_.end(),this->cell_colptr_[I-1]+1);
+        for (Int idx = this->cell_colptr_[I-1]+1; idx < this->cell_colptr_[I]; idx++) {
+          this->cell_local_ptrs_[idx]->trsm(ptr_diagcell,tmpBuf,limits);
+        }
+        for (; export_it != this->export_cells_.end() && *export_it < this->cell_colptr_[I]; export_it++) {
+          this->send_export_(std::distance(this->export_cells_.begin(),export_it));
+        }
+      }
+      //Scan through all dependent tasks, set metadata of dependent tasks, including the global pointer of the dependent task. (which will be on the src processor)
+      auto & out_deps = this->task_graph.out_dependencies;
+      for (auto g = out_deps.first(ptask->index); g < out_deps.last(ptask->index); g++) {
+        auto pdest = out_deps.rank(g);
+        auto tgt_cells = out_deps.targets(g);
+        //serialize data once, and list of meta data
+        //factor is output data so it will not be deleted
+#ifdef CUDA_MODE
+        bool is_gpu_block = false;
+        if (pdest != this->iam 
+            && ptr_diagcell->_nnz*sizeof(T)>symPACK::gpu_block_limit
+            && tgt_cells.size()>0) {
+                is_gpu_block = true;
+        }
+#endif
+        if ( pdest != this->iam ) {
+#ifdef CUDA_MODE
+          this->notify_cell_(pdest,Factorization::op_type::FACTOR,ptr_diagcell,ptask->_meta,tgt_cells,is_gpu_block);
+#else
+          this->notify_cell_(pdest,Factorization::op_type::FACTOR,ptr_diagcell,ptask->_meta,tgt_cells);
+#endif
+        }
+        else {
+          for ( auto & tgt_cell_idx: tgt_cells ) {
+            auto taskptr = task_graph[tgt_cell_idx].get();
+            bassert(taskptr!=nullptr); 
+            bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::TRSM
+                ||  std::get<2>(taskptr->_meta) == Factorization::op_type::DLT2D_COMP
+                ||  std::get<2>(taskptr->_meta) == Factorization::op_type::UPDATE2D_COMP);
+            //mark the dependency as satisfied
+            taskptr->satisfy_dep(1,this->scheduler);
+          }
+        }
+      }
+
+#ifdef _TIMING_
+      deps_fact_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
+#endif
+      //TODO what do do with the task OR return a future
+      ptask->executed = true;
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::trsm_task_( SparseTask2D * ptask, TempUpdateBuffers<T> & tmpBuf, const kernels::narrow_limits_t & limits ) {
+      scope_timer(b,FB_TRSM_TASK);
+      auto I = std::get<0>(ptask->_meta);
+      auto K = this->SupMembership_[std::get<4>(ptask->_meta)-1];
+      auto ptr_od_cell = pQueryCELL2(K-1,I-1);
+      assert(ptr_od_cell);
+
+      bassert( ptr_od_cell->owner == this->iam);
+
+      {
+#ifdef SP_THREADS
+        cell_lock<snodeBlock_t*> lock(ptr_od_cell);
+#endif
+
+
+        //input data is one or 0 (local diagonal block)
+        bassert(ptask->input_msg.size()<=1);
+        auto ptr_diagCell = pQueryCELL(I-1,I-1); 
+#if not defined(_NO_COMPUTATION_)
+        if ( ptr_diagCell->owner != this->iam ) {
+          ptr_diagCell = (snodeBlock_t*)(ptask->input_msg.begin()->get()->extra_data.get());
+        }
+        bassert(ptr_diagCell!=nullptr);
+#endif
+
+#ifdef _TIMING_
+        std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+#endif
+        //TODO DEBUG
+        ptr_od_cell->trsm(ptr_diagCell,tmpBuf,limits);
+#ifdef _TIMING_
+        std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+        comp_trsm_ticks += std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+#endif
+      }
+#ifdef _TIMING_
+      start = gasneti_ticks_now();
+#endif
+      //Iterate thru dependent tasks
+      auto & out_deps = this->task_graph.out_dependencies;
+      for (auto g = out_deps.first(ptask->index); g < out_deps.last(ptask->index); g++) {
+        auto pdest = out_deps.rank(g);
+        auto tgt_cells = out_deps.targets(g);
+        //serialize data once, and list of meta data
+        //factor is output data so it will not be deleted
+        if ( pdest != this->iam ) {
+          this->notify_cell_(pdest,Factorization::op_type::TRSM,ptr_od_cell,ptask->_meta,tgt_cells);
+        }
+        else {
+          std::shared_ptr<SparseTask2D::data_t> diag_data;
+          if (this->options_.decomposition == DecompositionType::LDL) {
+            auto ptr_ldl = (snodeBlockLDL_t*)(ptr_od_cell);
+            ptr_ldl->local_pivot = 0;
+          }
+          for ( auto & tgt_cell_idx: tgt_cells ) {
+            auto taskptr = task_graph[tgt_cell_idx].get();
+            bassert(taskptr!=nullptr); 
+            bassert( std::get<2>(taskptr->_meta)==Factorization::op_type::DLT2D_COMP
+                || std::get<2>(taskptr->_meta)==Factorization::op_type::UPDATE2D_COMP);
+
+
+            if (std::get<2>(taskptr->_meta)==Factorization::op_type::UPDATE2D_COMP &&
+                this->options_.decomposition == DecompositionType::LDL) {
+              auto ptr_ldl = (snodeBlockLDL_t*)(ptr_od_cell);
+              //get coordinates of target cell and check if ptr_od_cell is a pivot or a facing cell
+              auto tJ = std::get<1>(taskptr->_meta);
+              if ( ptr_ldl->i == tJ ) {
+                ptr_ldl->local_pivot++;
+              }
+            }
+
+            //mark the dependency as satisfied
+            taskptr->satisfy_dep(1,this->scheduler);
+          }
+        }
+      }
+
+#ifdef _TIMING_
+      deps_trsm_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
+#endif
+
+      ptask->executed = true;
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::dlt_task_( SparseTask2D * ptask ) {
+      scope_timer(b,FB_DLT2D_TASK);
+      auto I = std::get<0>(ptask->_meta);
+      auto J = std::get<1>(ptask->_meta);
+
+      bassert(this->options_.decomposition == DecompositionType::LDL);
+
+      T * diag_ptr = nullptr;
+      auto ptr_odCell = pQueryCELL(J-1,I-1); 
+      bool odSet = false;
+      bool diagSet = false;
+      for ( auto && msg_ptr: ptask->input_msg ) {
+        if ( msg_ptr->extra_data ) {
+          if ( ptr_odCell->owner != this->iam && !odSet) {
+            odSet = true;
+            ptr_odCell = (snodeBlock_t*)(msg_ptr->extra_data.get());
+          }
+#ifndef NDEBUG
+          else if (odSet && msg_ptr->extra_data.get() != ptr_odCell){
+            gdb_lock();
+          }
+#endif
+        }
+        else {
+          diagSet = true;
+          diag_ptr = (T*)msg_ptr->landing_zone;
+        }
+      }
+
+
+
+      if ( ! diagSet) {
+        auto ptr_diagCell = pQueryCELL(I-1,I-1);
+        bassert(ptr_diagCell->owner == this->iam);
+        diag_ptr = (T*)dynamic_cast<snodeBlockLDL_t*>(ptr_diagCell)->GetDiag();
+      }
+
+      auto ptr_odCellLDL =  dynamic_cast<snodeBlockLDL_t*>(ptr_odCell);
+
+      if ( ptr_odCellLDL->owner == this->iam ) {
+        bassert( ptr_odCellLDL->local_pivot>0 );
+
+        if ( ptr_odCellLDL->_bufLDL == nullptr ) {
+          ptr_odCellLDL->computeDLT(diag_ptr);
+        }
+      }
+      else{
+        if ( ptr_odCellLDL->_bufLDL == nullptr ) {
+          ptr_odCellLDL->computeDLT(diag_ptr);
+        }
+      }
+
+      //Signal the LOCAL dependencies
+      auto & out_deps = this->task_graph.out_dependencies;
+      for (auto g = out_deps.first(ptask->index); g < out_deps.last(ptask->index); g++) {
+        auto pdest = out_deps.rank(g);
+        auto tgt_cells = out_deps.targets(g);
+        //serialize data once, and list of meta data
+        //factor is output data so it will not be deleted
+        bassert ( pdest == this->iam );
+        for ( auto & tgt_cell_idx: tgt_cells ) {
+          auto taskptr = task_graph[tgt_cell_idx].get();
+          bassert(taskptr!=nullptr); 
+          bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::UPDATE2D_COMP);
+          //mark the dependency as satisfied
+          taskptr->satisfy_dep(1,this->scheduler);
+        }
+
+      }
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::update_task_( SparseTask2D * ptask, TempUpdateBuffers<T> & tmpBuf, const kernels::narrow_limits_t & limits ) {
+      scope_timer(b,FB_UPDATE2D_TASK);
+      auto J = std::get<1>(ptask->_meta);
+      auto K = this->SupMembership_[std::get<4>(ptask->_meta)-1];
+      update_map_t<rowind_t> * pmap = this->options_.reuse_update_maps ? &this->update_maps_[ptask->index] : nullptr;
+
+      auto ptr_upd_cell = pQueryCELL2(K-1,J-1);
+      assert(ptr_upd_cell);
+      //TODO false for fan-both
+      bassert(ptr_upd_cell->owner==this->iam);
+
+      {
+#ifdef SP_THREADS
+        cell_lock<snodeBlock_t*> lock(ptr_upd_cell);
+#endif
+
+        if ( this->whole_column(J) ) {
+          //the task on the diagonal cell updates the whole column: the pivot is
+          //cell (J,I) and each cell (K,I) below it updates cell (K,J)
+          auto I = std::get<0>(ptask->_meta);
+          auto input_cell = [this,ptask,I](Int K) {
+            blockCellBase_t * ptr_cell = pQueryCELL(K-1,I-1);
+#if not defined(_NO_COMPUTATION_)
+            if ( ptr_cell->owner != this->iam ) {
+              ptr_cell = nullptr;
+              for ( auto && msg_ptr: ptask->input_msg ) {
+                auto ptr_in = msg_ptr->extra_data.get();
+                if ( ptr_in->i == K && ptr_in->j == I ) { ptr_cell = ptr_in; break; }
+              }
+              bassert(ptr_cell!=nullptr);
+            }
+#endif
+            return ptr_cell;
+          };
+          auto ptr_odCell = input_cell(J);
+          for (Int idx = this->cell_index_(J-1,I-1); idx < this->cell_colptr_[I]; idx++) {
+            Int K = this->cell_rowind_[idx]+1;
+            pQueryCELL2(K-1,J-1)->update(ptr_odCell,input_cell(K),tmpBuf,limits);
+          }
+        }
+        else {
+          blockCellBase_t * ptr_odCell = nullptr;
+          blockCellBase_t * ptr_facingCell = nullptr;
+          this->update_operands_(ptask,ptr_odCell,ptr_facingCell);
+
+#ifdef _TIMING_
+          std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+#endif
+
+          if (this->options_.decomposition == DecompositionType::LDL) {
+#ifndef NDEBUG
+#if not defined(_NO_COMPUTATION_)
+            auto ptr_od = dynamic_cast<snodeBlockLDL_t*>(ptr_odCell);
+            auto ptr_facing = dynamic_cast<snodeBlockLDL_t*>(ptr_facingCell);
+            bassert(ptr_od!=nullptr);
+            bassert(ptr_facing!=nullptr);
+#endif
+#endif
+            ptr_upd_cell->update(ptr_odCell,ptr_facingCell,tmpBuf,limits,nullptr,pmap);
+          }
+          else {
+            ptr_upd_cell->update(ptr_odCell,ptr_facingCell,tmpBuf,limits,nullptr,pmap);
+          }
+
+#ifdef _TIMING_
+          std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+          comp_upd_ticks += std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+#endif
+        }
+
+      }
+
+      auto & out_deps = this->task_graph.out_dependencies;
+      for (auto g = out_deps.first(ptask->index); g < out_deps.last(ptask->index); g++) {
+        auto pdest = out_deps.rank(g);
+        auto tgt_cells = out_deps.targets(g);
+        //serialize data once, and list of meta data
+        //factor is output data so it will not be deleted
+        if ( pdest != this->iam ) {
+          this->notify_cell_(pdest,Factorization::op_type::UPDATE2D_COMP,ptr_upd_cell,ptask->_meta,tgt_cells);
+        }
+        else {
+          for ( auto & tgt_cell_idx: tgt_cells ) {
+            auto taskptr = task_graph[tgt_cell_idx].get();
+            bassert(taskptr!=nullptr); 
+            bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::FACTOR || std::get<2>(taskptr->_meta)==Factorization::op_type::TRSM);
+            //mark the dependency as satisfied
+            taskptr->satisfy_dep(1,this->scheduler);
+          }
+        }
+      }
+
+#ifdef _TIMING_
+      deps_upd_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
+#endif
+
+      ptask->executed = true;
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::subtree_task_( SparseTask2D * ptask, TempUpdateBuffers<T> & tmpBuf, const kernels::narrow_limits_t & limits ) {
+      scope_timer(b,FB_SUBTREE2D_TASK);
+      Int first = std::get<0>(ptask->_meta);
+      Int root = std::get<1>(ptask->_meta);
+      auto export_it = std::lower_bound(this->export_cells_.begin(),this->export_cells_.end(),this->cell_colptr_[first-1]);
+
+      for (Int J = first; J <= root; J++) {
+        //left-looking: the updates from the subtree are applied before J is factored
+        for (Int pos = this->subtree_src_ptr_[J-1]; pos < this->subtree_src_ptr_[J]; pos++) {
+          Int I = this->subtree_src_[pos];
+          Int od_idx = this->cell_index_(J-1,I-1);
+          auto ptr_od_cell = this->cell_local_ptrs_[od_idx];
+          for (Int idx = od_idx; idx < this->cell_colptr_[I]; idx++) {
+            Int K = this->cell_rowind_[idx]+1;
+            auto ptr_upd_cell = pQueryCELL2(K-1,J-1);
+            ptr_upd_cell->update(ptr_od_cell,this->cell_local_ptrs_[idx],tmpBuf,limits);
+          }
+        }
+
+        auto ptr_diagcell = pQueryCELL2(J-1,J-1);
+        ptr_diagcell->factorize(tmpBuf,limits);
+        for (Int idx = this->cell_colptr_[J-1]+1; idx < this->cell_colptr_[J]; idx++) {
+          this->cell_local_ptrs_[idx]->trsm(ptr_diagcell,tmpBuf,limits);
+        }
+
+        //the cells of J read by the upper tree are final
+        for (; export_it != this->export_cells_.end() && *export_it < this->cell_colptr_[J]; export_it++) {
+          this->send_export_(std::distance(this->export_cells_.begin(),export_it));
+        }
+      }
+
+      ptask->executed = true;
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::send_export_( std::size_t e ) {
+      auto & out_deps = this->export_deps_;
+      auto ptr_cell = this->cell_local_ptrs_[this->export_cells_[e]];
+      //the cell is sent as if a TRSM task had produced it
+      Int I = ptr_cell->j;
+      rowind_t first_row = ptr_cell->blocks()[0].first_row;
+      SparseTask2D::meta_t meta = std::make_tuple(I,I,Factorization::op_type::TRSM,first_row,first_row);
+      for (auto g = out_deps.first(e); g < out_deps.last(e); g++) {
+        auto pdest = out_deps.rank(g);
+        auto tgt_cells = out_deps.targets(g);
+        if ( pdest != this->iam ) {
+          this->notify_cell_(pdest,Factorization::op_type::TRSM,ptr_cell,meta,tgt_cells);
+        }
+        else {
+          for ( auto & tgt_cell_idx: tgt_cells ) {
+            auto taskptr = task_graph[tgt_cell_idx].get();
+            bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::UPDATE2D_COMP);
+            taskptr->satisfy_dep(1,this->scheduler);
+          }
+        }
+      }
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::update_operands_( SparseTask2D * ptask, blockCellBase_t *& ptr_odCell, blockCellBase_t *& ptr_facingCell ) {
+      auto I = std::get<0>(ptask->_meta);
+      auto J = std::get<1>(ptask->_meta);
+      auto K = this->SupMembership_[std::get<4>(ptask->_meta)-1];
+
+      //input data should be at most two
+      bassert(ptask->input_msg.size()<=2 );
+
+      ptr_odCell = pQueryCELL(J-1,I-1); 
+      ptr_facingCell = pQueryCELL(K-1,I-1); 
+#if not defined(_NO_COMPUTATION_)
+      bool odSet = false;
+      bool facingSet = false;
+      for ( auto && msg_ptr: ptask->input_msg ) {
+        bassert ( msg_ptr->extra_data != nullptr );
+        if ( ptr_odCell->owner != this->iam && !odSet) {
+          odSet = true;
+          ptr_odCell = (snodeBlock_t*)(msg_ptr->extra_data.get());
+        }
+        else if ( ptr_facingCell->owner != this->iam && !facingSet) {
+          facingSet = true;
+          ptr_facingCell = (snodeBlock_t*)(msg_ptr->extra_data.get());
+        }
+      }
+
+      bassert( !odSet || ptr_odCell != pQueryCELL(J-1,I-1) );
+      bassert( !facingSet || ptr_facingCell != pQueryCELL(K-1,I-1) );
+
+      bassert( ptr_facingCell->owner == this->iam || ptr_facingCell != pQueryCELL(K-1,I-1) );
+      bassert( ptr_odCell->owner == this->iam || ptr_odCell != pQueryCELL(J-1,I-1) );
+
+      bassert(ptr_odCell!=nullptr);
+      bassert(ptr_facingCell!=nullptr);
+      //check that they don't need to be swapped
+      if ( ptr_facingCell->i < ptr_odCell->i ) {
+        std::swap(ptr_facingCell, ptr_odCell);
+      }
+#endif
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::fuc_task_( SparseTask2D * ptask ) {
+      scope_timer(b,SOLVE_FUC_TASK);
+      auto J = std::get<0>(ptask->_meta);
+      auto I = std::get<1>(ptask->_meta);
+      int dep_cnt = this->solve_right_deps_[J];
+      auto ptr_cell = pQueryCELL2(J-1,I-1);
+      auto & update_right_cnt = this->solve_data.update_right_cnt;
+      auto & contribs = this->solve_data.contribs;
+      auto rhs = this->solve_data.rhs;
+     		  auto nrhs = this->solve_data.nrhs;
+      snodeBlock_sptr_t ptr_contrib = nullptr;
+
+      if ( I == J ) {
+        { 
+#ifdef SP_THREADS
+          cell_lock<std::atomic<bool> > lock_cell(this->solve_data.contribs_lock[J]);
+#endif
+          {
+            //Allocate Y(K) with the same structure as L(K,M) where M is the highest anscestor in the Etree this rank owns
+            auto & contrib_slot = contribs[J];
+            auto & rptr_contrib = std::get<1>(contrib_slot);
+            if ( ! rptr_contrib ) {
+              bassert(update_right_cnt[J] == 0);
+              rptr_contrib = std::static_pointer_cast<snodeBlock_t>(this->options_.decomposition == DecompositionType::LDL?std::make_shared<snodeBlockLDL_t>():std::make_shared<snodeBlock_t>());
+              auto ptr_test_cell = pQueryCELL(J-1,J-1);
+              bassert( ptr_test_cell->owner == this->iam );
+			  //copy ptr_cell test into new rptr_contrib block
+              rptr_contrib->copy_row_structure(nrhs,(snodeBlock_t*)ptr_test_cell,this->solve_arena());
+              for (rowind_t row = 0; row< rptr_contrib->total_rows(); ++row) {
+                rowind_t srcRow = this->Order_.perm[rptr_contrib->first_col-1+row] -1;
+                for (rowind_t col = 0; col<nrhs;++col) {
+                  rptr_contrib->_nzval[row*nrhs+col] = rhs[srcRow + col*this->iSize_];
+                }
+      			  }
+            }
+            else {
+              bassert( rptr_contrib->nnz() >0 && rptr_contrib->width()>0);
+              //Add data from RHS
+              for (rowind_t row = 0; row< rptr_contrib->total_rows(); ++row) {
+                rowind_t srcRow = this->Order_.perm[rptr_contrib->first_col-1+row] -1;
+                for (rowind_t col = 0; col<nrhs;++col) {
+                  rptr_contrib->_nzval[row*nrhs+col] += rhs[srcRow + col*this->iSize_];
+                }
+              }	
+            }
+            ptr_contrib = rptr_contrib;
+          }
+
+
+          //Then accumulate everything coming from children
+          for ( auto && msg_ptr: ptask->input_msg ) {
+            if ( msg_ptr->extra_data ) {
+              auto ptr_rem_contrib = (snodeBlock_t*)(msg_ptr->extra_data.get());
+              ptr_contrib->forward_update(ptr_rem_contrib);
+            }
+          }
+
+          //compute the product Y(J) -= L(J,J) * Y(J)
+          ptr_cell->forward_update_contrib(ptr_contrib.get());
+        } //release the lock here
+
+        //send the contrib down
+        auto & out_deps = this->task_graph_solve.out_dependencies;
+        for (auto g = out_deps.first(ptask->index); g < out_deps.last(ptask->index); g++) {
+          auto pdest = out_deps.rank(g);
+          auto tgt_cells = out_deps.targets(g);
+          //serialize data once, and list of meta data
+          //diag contrib is output data so it will not be deleted
+          if ( pdest != this->iam ) {
+            upcxx::rpc_ff( pdest,  
+                [] (int sp_handle, upcxx::global_ptr<char> gptr,
+				size_t storage_size, size_t nnz, size_t nblocks, rowind_t width,  SparseTask2D::meta_t meta, 
+				upcxx::view<std::size_t> target_cells ) { 
+                    //there is a map between sp_handle and task_graphs
+                    auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
+                    auto I = std::get<1>(meta);
+                    rowind_t fc = matptr->Xsuper_[I-1];
+
+                    //store pointer & associated metadata somewhere
+                    std::shared_ptr <SparseTask2D::data_t > data;
+
+                    for ( auto & tgt_cell_idx: target_cells) {
+                    auto taskptr = matptr->task_graph_solve[tgt_cell_idx].get();
+                    {
+                    if ( ! data ) {
+                    data = std::make_shared<SparseTask2D::data_t >();
+                    data->in_meta = meta;
+                    data->size = storage_size;
+                    data->remote_gptr = gptr;
+                    }
+
+                    taskptr->input_msg.push_back(data);
+                    data->target_tasks.push_back(taskptr);
+                    taskptr->avail_dep(1,matptr->scheduler);
+                    }
+                    }
+
+
+                    if ( data ) {
+                      data->on_fetch_future = data->on_fetch_future.then(
+                          [fc,width,nnz,nblocks,I,matptr](SparseTask2D::data_t * pdata) {
+                          //create snodeBlock_t and store it in the extra_data
+                          if (matptr->options_.decomposition == DecompositionType::LDL) {
+                            pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks,0) );
+                          }
+                          else {
+                            pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
+                          }
+                          return upcxx::to_future(pdata);
+                          });
+                      //TODO check this
+#ifdef _EAGER_FETCH_
+                      matptr->scheduler.eager_fetch(*data);
+#endif
+                    }
+
+
+                }, this->sp_handle, ptr_contrib->_gstorage, 
+			       ptr_contrib->_storage_size, ptr_contrib->nnz(), ptr_contrib->nblocks(), 
+			       ptr_contrib->width(), ptask->_meta, upcxx::make_view(tgt_cells.begin(),tgt_cells.end())); 
+          }
+          else {
+            for ( auto & tgt_cell_idx: tgt_cells ) {
+              auto taskptr = task_graph_solve[tgt_cell_idx].get();
+              bassert(taskptr!=nullptr); 
+              bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::FUC
+                  || std::get<2>(taskptr->_meta)==Factorization::op_type::BUC);
+              //mark the dependency as satisfied
+              taskptr->satisfy_dep(1,this->scheduler);
+            }
+          }
+        }
+      }
+      else {
+        bool deleteContrib = false;
+        {
+#ifdef SP_THREADS
+          cell_lock<std::atomic<bool> > lock_cell(this->solve_data.contribs_lock[J]);
+#endif
+          {
+            auto & contrib_slot = contribs[J];
+            auto & counter = std::get<0>(contrib_slot);
+
+            auto & rptr_contrib = std::get<1>(contrib_slot);
+            if ( ! rptr_contrib ) {
+              bassert(update_right_cnt[J] == 0);
+
+              rptr_contrib = std::static_pointer_cast<snodeBlock_t>(this->options_.decomposition == DecompositionType::LDL?std::make_shared<snodeBlockLDL_t>():std::make_shared<snodeBlock_t>());
+
+              rowind_t nrows = this->Xsuper_[J] - this->Xsuper_[J-1];
+              
+			  rptr_contrib = std::static_pointer_cast<snodeBlock_t>(this->options_.decomposition == DecompositionType::LDL?std::make_shared<snodeBlockLDL_t>(J,J,this->Xsuper_[J-1],nrhs,nrows*nrhs,1,nrows,true,this->solve_arena()):std::make_shared<snodeBlock_t>(J,J,this->Xsuper_[J-1],nrhs,nrows*nrhs,1,true,this->solve_arena()));
+              
+			  //TODO THIS IS TERRIBLE!!!
+			  rptr_contrib->add_block(this->Xsuper_[J-1],nrows);
+			  //TODO: add cublas scal here
+              std::fill(rptr_contrib->_nzval,rptr_contrib->_nzval+rptr_contrib->_nnz,T(0));
+     			}
+
+
+            if (dep_cnt>0) {
+              auto ptr_test_cell = pQueryCELL(J-1,J-1);
+              if ( ptr_test_cell->owner != this->iam ) {
+                deleteContrib = true;
+
+                if (update_right_cnt[J] == 0 ) {
+                  //TODO THIS IS NOT THREADSAFE, CAN THIS BE DONE BEFORE?
+                  ((*this->solve_data.remoteDeallocCounter))+=dep_cnt;
+                  counter+=dep_cnt;
+                }
+                else {
+                }
+              }
+            }
+
+
+            ptr_contrib = rptr_contrib;
+          }
+
+
+
+          bassert(ptask->input_msg.size() <= 1 );
+          //unpack the part of the solution (y) facing the diagonal block of the supernode
+          auto ptr_diagContrib = pQueryCELL(I-1,I-1); 
+          if ( ptr_diagContrib->owner == this->iam ) {
+            auto tmp2 = contribs.at(I);
+            auto tmp = contribs[I];
+            ptr_diagContrib = std::get<1>(contribs[I]).get();
+            bassert(ptr_diagContrib != nullptr);
+          }
+          else {
+            if ( ptask->input_msg.size() > 0 ) {
+              auto msg_ptr = *ptask->input_msg.begin();
+              bassert ( msg_ptr->extra_data != nullptr );
+              ptr_diagContrib = msg_ptr->extra_data.get();
+            }
+          }
+
+          bassert(I<J);
+          //compute the product Y(J) -= L(J,I) * Y(I)
+          ptr_cell->forward_update_contrib(ptr_contrib.get(),ptr_diagContrib);
+        } //release the lock here
+
+        //send the contrib
+        auto & out_deps = this->task_graph_solve.out_dependencies;
+        for (auto g = out_deps.first(ptask->index); g < out_deps.last(ptask->index); g++) {
+          auto pdest = out_deps.rank(g);
+          auto tgt_cells = out_deps.targets(g);
+          //serialize data once, and list of meta data
+          //factor is output data so it will not be deleted
+          if ( pdest != this->iam ) {
+            update_right_cnt[J]++;
+            if ( dep_cnt == update_right_cnt[J]) {
+              upcxx::rpc_ff( pdest, 
+                  [dep_cnt,deleteContrib ] (int sp_handle, upcxx::global_ptr<char> gptr, 
+				      			size_t storage_size, size_t nnz, size_t nblocks, rowind_t width, SparseTask2D::meta_t meta, upcxx::view<std::size_t> target_cells ) { 
+                      //there is a map between sp_handle and task_graphs
+                      auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
+                      auto I = std::get<1>(meta);
+                      auto J = std::get<0>(meta);
+
+
+                      rowind_t fc = matptr->Xsuper_[I-1];
+
+                      //store pointer & associated metadata somewhere
+                      std::shared_ptr <SparseTask2D::data_t > data;
+
+                      for ( auto & tgt_cell_idx: target_cells) {
+                      auto taskptr = matptr->task_graph_solve[tgt_cell_idx].get();
+                      if ( ! data ) {
+                      data = std::make_shared<SparseTask2D::data_t >();
+                      data->in_meta = meta;
+                      data->size = storage_size;
+                      data->remote_gptr = gptr;
+				  }
+
+
+                      taskptr->input_msg.push_back(data);
+                      data->target_tasks.push_back(taskptr);
+                      taskptr->avail_dep(dep_cnt,matptr->scheduler);
+
+                      if (dep_cnt>1) {
+                        taskptr->satisfy_dep(dep_cnt-1,matptr->scheduler);
+                      }
+                      }
+
+
+                      if ( data ) {
+                        int owner = gptr.where();
+                        data->on_fetch_future = data->on_fetch_future.then(
+                            [fc,width,nnz,nblocks,I,matptr,sp_handle,dep_cnt,owner,J,deleteContrib](SparseTask2D::data_t * pdata) {
+                            //create snodeBlock_t and store it in the extra_data
+                            if (matptr->options_.decomposition == DecompositionType::LDL) {
+                            pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks,0) );
+                            }
+                            else {
+					pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
+					}
+
+                            //send a rpc_ff on the owner of the data to signal we have fetched it
+                            if ( deleteContrib ) {
+                              if ( pdata->is_view ) {
+                                //the contribution is read in place, wait for all the local consumers
+                                pdata->on_release = [matptr,owner,sp_handle,J,dep_cnt]() {
+                                  upcxx::master_persona().lpc_ff( [matptr,owner,sp_handle,J,dep_cnt]() {
+                                      matptr->solve_data.deallocRemote(owner,sp_handle,J,dep_cnt);
+                                      });
+                                };
+                              }
+                              else {
+                                matptr->solve_data.deallocRemote(owner,sp_handle,J,dep_cnt);
+                              }
+                            }
+
+                            return upcxx::to_future(pdata);
+                            });
+                        //TODO check this
+#ifdef _EAGER_FETCH_
+                        matptr->scheduler.eager_fetch(*data);
+#endif
+                      }
+
+                  }, this->sp_handle, ptr_contrib->_gstorage,
+			 	 ptr_contrib->_storage_size, ptr_contrib->nnz(), ptr_contrib->nblocks(), ptr_contrib->width() ,ptask->_meta, upcxx::make_view(tgt_cells.begin(),tgt_cells.end())); 
+            }
+          }
+          else {
+            for ( auto & tgt_cell_idx: tgt_cells ) {
+              auto taskptr = task_graph_solve[tgt_cell_idx].get();
+              bassert(taskptr!=nullptr); 
+              bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::FUC);
+              //mark the dependency as satisfied
+              taskptr->satisfy_dep(1,this->scheduler);
+            }
+          }
+        }
+      }
+      ptask->executed = true;
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::buc_task_( SparseTask2D * ptask ) {
+      scope_timer(b,SOLVE_BUC_TASK);
+      auto J = std::get<0>(ptask->_meta);
+      auto I = std::get<1>(ptask->_meta);
+      int dep_cnt = this->solve_up_deps_[I];
+      auto ptr_cell = pQueryCELL2(J-1,I-1);
+
+      auto & update_up_cnt = this->solve_data.update_up_cnt;
+      auto & contribs = this->solve_data.contribs;
+      auto rhs = this->solve_data.rhs;
+      auto nrhs = this->solve_data.nrhs;
+      auto ptr_tgtcell = pQueryCELL(I-1,I-1);
+
+      snodeBlock_sptr_t ptr_contrib = nullptr;
+      if ( I == J ) {
+        {
+#ifdef SP_THREADS
+          cell_lock<std::atomic<bool> > lock_cell(this->solve_data.contribs_lock[I]);
+#endif
+          {
+            bassert ( ptr_tgtcell->owner == this->iam ) ;
+            auto & contrib_slot = contribs[I];
+            auto & rptr_contrib = std::get<1>(contrib_slot);
+            bassert( rptr_contrib != nullptr );
+            bassert( rptr_contrib->nnz() >0 && rptr_contrib->width()>0);
+            ptr_contrib = rptr_contrib;
+          }  
+          if (this->options_.decomposition == DecompositionType::LDL) {
+            if ( ptr_tgtcell->owner == this->iam ) {
+              auto & tgt_ldlcell = *std::dynamic_pointer_cast<snodeBlockLDL_t>(ptr_contrib);
+              if(!tgt_ldlcell.scaled){
+                ((snodeBlockLDL_t*)ptr_tgtcell)->scale_contrib(&tgt_ldlcell);
+              }
+            }
+          }
+          //Then accumulate everything coming from children
+          for ( auto && msg_ptr: ptask->input_msg ) {
+            if ( msg_ptr->extra_data ) {
+              auto ptr_rem_contrib = (snodeBlock_t*)(msg_ptr->extra_data.get());
+              ptr_contrib->back_update(ptr_rem_contrib);
+            }
+          }
+
+          //this is a diagonal block update
+          //this could be implemented as a straight trsm
+          //compute the product Y(I) -= L(I,I)^T * Y(I)
+          ptr_cell->back_update_contrib(ptr_contrib.get());
+
+
+#ifndef NDEBUG
+          if (this->options_.decomposition == DecompositionType::LDL) {
+            auto tgt_ldlcell = (snodeBlockLDL_t*)(ptr_contrib.get());
+            bassert(tgt_ldlcell->scaled);
+          }
+#endif
+        }
+        //send the contrib left
+        auto & out_deps = this->task_graph_solve.out_dependencies;
+        for (auto g = out_deps.first(ptask->index); g < out_deps.last(ptask->index); g++) {
+          auto pdest = out_deps.rank(g);
+          auto tgt_cells = out_deps.targets(g);
+          //serialize data once, and list of meta data
+          //diag contrib is output data so it will not be deleted
+          if ( pdest != this->iam ) {
+            upcxx::rpc_ff( pdest,  
+                [ ] (int sp_handle, upcxx::global_ptr<char> gptr, 
+				 size_t storage_size, size_t nnz, size_t nblocks, rowind_t width, SparseTask2D::meta_t meta, upcxx::view<std::size_t> target_cells ) { 
+                    //there is a map between sp_handle and task_graphs
+                    auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
+                    auto I = std::get<1>(meta);
+                    rowind_t fc = matptr->Xsuper_[I-1];
+
+                    //store pointer & associated metadata somewhere
+                    std::shared_ptr <SparseTask2D::data_t > data;
+
+                    for ( auto & tgt_cell_idx: target_cells) {
+                    auto taskptr = matptr->task_graph_solve[tgt_cell_idx].get();
+
+
+                    {
+                    if ( ! data ) {
+                    data = std::make_shared<SparseTask2D::data_t >();
+                    data->in_meta = meta;
+                    data->size = storage_size;
+                    data->remote_gptr = gptr;
+                    }
+
+                    taskptr->input_msg.push_back(data);
+                    data->target_tasks.push_back(taskptr);
+                    taskptr->avail_dep(1,matptr->scheduler);
+                    }
+                    }
+
+
+                    if ( data ) {
+                      data->on_fetch_future = data->on_fetch_future.then(
+                          [fc,width,nnz,nblocks,I,matptr](SparseTask2D::data_t * pdata) {
+                          //create snodeBlock_t and store it in the extra_data
+                          if (matptr->options_.decomposition == DecompositionType::LDL) {
+                          pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks,0) );
+                          }
+                          else {
+                          pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
+                          }
+                          return upcxx::to_future(pdata); 
+                          });
+                      //TODO check this
+#ifdef _EAGER_FETCH_
+                      matptr->scheduler.eager_fetch(*data);
+#endif
+                    }
+
+
+                },  this->sp_handle, ptr_contrib->_gstorage,
+			        ptr_contrib->_storage_size, ptr_contrib->nnz(), ptr_contrib->nblocks(), ptr_contrib->width(), ptask->_meta, upcxx::make_view(tgt_cells.begin(),tgt_cells.end())); 
+          }
+          else {
+            for ( auto & tgt_cell_idx: tgt_cells ) {
+              auto taskptr = task_graph_solve[tgt_cell_idx].get();
+              bassert(taskptr!=nullptr); 
+              bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::BUC);
+              //mark the dependency as satisfied
+              taskptr->satisfy_dep(1,this->scheduler);
+            }
+          }
+        }
+      }
+      else {
+        bool deleteContrib = false;
+        {
+#ifdef SP_THREADS
+          cell_lock<std::atomic<bool> > lock_cell(this->solve_data.contribs_lock[I]);
+#endif
+          {
+            {
+              auto & contrib_slot = contribs[I];
+              auto & counter = std::get<0>(contrib_slot);
+              auto & rptr_contrib = std::get<1>(contrib_slot);
+
+
+              if ( ptr_tgtcell->owner != this->iam ) {
+                if (update_up_cnt[I] == 0 ) {
+                  if ( !rptr_contrib ) {
+                    rowind_t nrows = this->Xsuper_[I] - this->Xsuper_[I-1];
+                    rptr_contrib = std::static_pointer_cast<snodeBlock_t>(this->options_.decomposition == DecompositionType::LDL?std::make_shared<snodeBlockLDL_t>(I,I,this->Xsuper_[I-1],nrhs,nrows*nrhs,1,nrows,true,this->solve_arena()):std::make_shared<snodeBlock_t>(I,I,this->Xsuper_[I-1],nrhs,nrows*nrhs,1,true,this->solve_arena()));
+                    //TODO THIS IS TERRIBLE!!!
+                    rptr_contrib->add_block(this->Xsuper_[I-1],nrows);
+
+                  }
+                  std::fill(rptr_contrib->_nzval,rptr_contrib->_nzval+rptr_contrib->_nnz,T(0));
+
+                }
+                else {
+                  bassert(rptr_contrib!=nullptr);
+                }
+
+                if (dep_cnt>0) {
+                  deleteContrib = true;
+
+                  if (deleteContrib && update_up_cnt[I] == 0 ) {
+                    //TODO THIS IS NOT THREADSAFE, CAN THIS BE DONE BEFORE?
+                    ((*this->solve_data.remoteDeallocCounter))+=dep_cnt;
+                    counter+=dep_cnt;
+                  }
+                }
+
+
+              }
+              else {
+                bassert(rptr_contrib!=nullptr);
+              }
+
+              bassert( rptr_contrib->nnz() >0 && rptr_contrib->width()>0);
+              ptr_contrib = rptr_contrib;
+            }
+
+            if (this->options_.decomposition == DecompositionType::LDL) {
+              if ( ptr_tgtcell->owner == this->iam ) {
+                auto & tgt_ldlcell = *std::dynamic_pointer_cast<snodeBlockLDL_t>(ptr_contrib);
+                if(!tgt_ldlcell.scaled){
+                  ((snodeBlockLDL_t*)ptr_tgtcell)->scale_contrib(&tgt_ldlcell);
+                }
+              }
+            }
+
+
+            bassert(ptask->input_msg.size() <= 1 );
+            //unpack the part of the solution (y) facing the diagonal block of the supernode
+            auto ptr_diagContrib = pQueryCELL(J-1,J-1); 
+            if ( ptr_diagContrib->owner == this->iam ) {
+              ptr_diagContrib = std::get<1>(contribs[J]).get();
+              bassert(ptr_diagContrib != nullptr);
+
+              if (this->options_.decomposition == DecompositionType::LDL) {
+                auto tgt_ldlcell = (snodeBlockLDL_t*)(ptr_diagContrib);
+                bassert(tgt_ldlcell->scaled);
+              }
+
+
+            }
+            else {
+              if ( ptask->input_msg.size() > 0 ) {
+                auto msg_ptr = *ptask->input_msg.begin();
+                bassert ( msg_ptr->extra_data != nullptr );
+                ptr_diagContrib = msg_ptr->extra_data.get();
+              }
+            }
+
+
+
+            //compute the product Y(I) -= L(I,J)^T * Y(J)
+            ptr_cell->back_update_contrib(ptr_contrib.get(),ptr_diagContrib);
+          }
+        }
+        //send the contrib up
+        auto & out_deps = this->task_graph_solve.out_dependencies;
+        for (auto g = out_deps.first(ptask->index); g < out_deps.last(ptask->index); g++) {
+          auto pdest = out_deps.rank(g);
+          auto tgt_cells = out_deps.targets(g);
+          //serialize data once, and list of meta data
+          //factor is output data so it will not be deleted
+          if ( pdest != this->iam ) {
+            update_up_cnt[I]++;
+            if ( dep_cnt == update_up_cnt[I]) {
+              upcxx::rpc_ff( pdest, 
+                  [ dep_cnt,deleteContrib ] (int sp_handle, upcxx::global_ptr<char> gptr, 
+				      			size_t storage_size, size_t nnz, size_t nblocks, rowind_t width, SparseTask2D::meta_t meta, upcxx::view<std::size_t> target_cells ) { 
+                      //there is a map between sp_handle and task_graphs
+                      auto matptr = (symPACKMatrix2D<colptr_t,rowind_t,T> *) g_sp_handle_to_matrix[sp_handle];
+                      auto I = std::get<1>(meta);
+                      rowind_t fc = matptr->Xsuper_[I-1];
+
+                      //store pointer & associated metadata somewhere
+                      std::shared_ptr <SparseTask2D::data_t > data;
+
+                      for ( auto & tgt_cell_idx: target_cells) {
+                      auto taskptr = matptr->task_graph_solve[tgt_cell_idx].get();
+                      if ( ! data ) {
+                      data = std::make_shared<SparseTask2D::data_t >();
+                      data->in_meta = meta;
+                      data->size = storage_size;
+                      data->remote_gptr = gptr;
+                      }
+
+
+                      taskptr->input_msg.push_back(data);
+                      data->target_tasks.push_back(taskptr);
+                      taskptr->avail_dep(dep_cnt,matptr->scheduler);
+
+                      if (dep_cnt>1) {
+                        taskptr->satisfy_dep(dep_cnt-1,matptr->scheduler);
+                      }
+                      }
+
+
+                      if ( data ) {
+                        int owner = gptr.where();
+                        data->on_fetch_future = data->on_fetch_future.then(
+                            [fc,width,nnz,nblocks,I,matptr,owner,sp_handle,dep_cnt,deleteContrib](SparseTask2D::data_t * pdata) {
+                            //create snodeBlock_t and store it in the extra_data
+                            if (matptr->options_.decomposition == DecompositionType::LDL) {
+                              pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks,0) );
+                            }
+                            else {
+                              pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
+                            }
+
+
+                            //send a rpc_ff on the owner of the data to signal we have fetched it
+                            if ( deleteContrib ) {
+                              if ( pdata->is_view ) {
+                                //the contribution is read in place, wait for all the local consumers
+                                pdata->on_release = [matptr,owner,sp_handle,I,dep_cnt]() {
+                                  upcxx::master_persona().lpc_ff( [matptr,owner,sp_handle,I,dep_cnt]() {
+                                      matptr->solve_data.deallocRemote(owner,sp_handle,I,dep_cnt);
+                                      });
+                                };
+                              }
+                              else {
+                                matptr->solve_data.deallocRemote(owner,sp_handle,I,dep_cnt);
+                              }
+                            }
+
+                            return upcxx::to_future(pdata);
+                            });
+#ifdef _EAGER_FETCH_
+                        matptr->scheduler.eager_fetch(*data);
+#endif
+                      }
+
+                  }, this->sp_handle, ptr_contrib->_gstorage,
+				ptr_contrib->_storage_size, ptr_contrib->nnz(), ptr_contrib->nblocks(), ptr_contrib->width(), ptask->_meta, upcxx::make_view(tgt_cells.begin(),tgt_cells.end())); 
+            }
+          }
+          else {
+            for ( auto & tgt_cell_idx: tgt_cells ) {
+              auto taskptr = task_graph_solve[tgt_cell_idx].get();
+              bassert(taskptr!=nullptr); 
+              bassert(std::get<2>(taskptr->_meta)==Factorization::op_type::BUC);
+              //mark the dependency as satisfied
+              taskptr->satisfy_dep(1,this->scheduler);
+            }
+          }
+        }
+      }
+      ptask->executed = true;
+    }
+
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::resolve_task_queries_( std::vector< std::tuple< scheduling::key_t, std::size_t > > & index,
+        scheduling::out_dependencies_t & deps, task_queries_t & queries ) {
+      std::vector<int> ssizes(this->np,0);
+      std::vector<int> sdispls(this->np+1,0);
+      std::vector<int> rsizes(this->np,0);
+      std::vector<int> rdispls(this->np+1,0);
+      for (int p = 0; p < this->np; p++) { ssizes[p] = queries.keys[p].size(); }
+      MPI_Alltoall(ssizes.data(),1,MPI_INT,rsizes.data(),1,MPI_INT,this->workcomm_);
+      std::partial_sum(ssizes.begin(),ssizes.end(),&sdispls[1]);
+      std::partial_sum(rsizes.begin(),rsizes.end(),&rdispls[1]);
+
+      std::vector<scheduling::key_t> sendbuf;
+      sendbuf.reserve(sdispls.back());
+      for (int p = 0; p < this->np; p++) { sendbuf.insert(sendbuf.end(),queries.keys[p].begin(),queries.keys[p].end()); }
+      std::vector<scheduling::key_t> recvbuf(rdispls.back());
+
+      MPI_Datatype key_type;
+      MPI_Type_contiguous( sizeof(scheduling::key_t), MPI_BYTE, &key_type );
+      MPI_Type_commit(&key_type);
+      MPI_Alltoallv(sendbuf.data(),ssizes.data(),sdispls.data(),key_type,recvbuf.data(),rsizes.data(),rdispls.data(),key_type,this->workcomm_);
+      MPI_Type_free(&key_type);
+
+      //answer with the index of the requested tasks in the local graph
+      auto key_lb_comp = [](const std::tuple<scheduling::key_t, std::size_t > & a, const scheduling::key_t & key) { return std::get<0>(a) < key;};
+      std::vector<std::size_t> answers(recvbuf.size());
+      for (size_t k = 0; k < recvbuf.size(); k++) {
+        auto task_idx_it = std::lower_bound(index.begin(), index.end(), recvbuf[k], key_lb_comp);
+        bassert(task_idx_it != index.end() && std::get<0>(*task_idx_it) == recvbuf[k]);
+        answers[k] = std::get<1>(*task_idx_it);
+      }
+      std::vector<std::size_t> results(sendbuf.size());
 
-                Int J = this->SupMembership_[row-1];
+      MPI_Datatype idx_type;
+      MPI_Type_contiguous( sizeof(std::size_t), MPI_BYTE, &idx_type );
+      MPI_Type_commit(&idx_type);
+      MPI_Alltoallv(answers.data(),rsizes.data(),rdispls.data(),idx_type,results.data(),ssizes.data(),sdispls.data(),idx_type,this->workcomm_);
+      MPI_Type_free(&idx_type);
 
-                auto ptr_tgt_cell = pQueryCELL(J-1,I-1);
-                assert(ptr_tgt_cell);
+      for (int p = 0; p < this->np; p++) {
+        for (int k = 0; k < ssizes[p]; k++) {
+          deps.set(queries.targets[p][k],results[sdispls[p]+k]);
+        }
+        queries.keys[p].clear();
+        queries.targets[p].clear();
+      }
+    }
 
-                auto & tgt_cell =CELL(J-1,I-1);
-                bassert(this->iam == tgt_cell.owner);
-                bassert(tgt_cell.i==J && tgt_cell.j==I);
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::notify_cell_( int pdest, Factorization::op_type op, snodeBlock_t * ptr_cell,
+        SparseTask2D::meta_t & meta, scheduling::task_range_t tgt_cells, bool gpu_block ) {
+      cell_notification_t msg;
+      msg.op = op;
+      msg.i = ptr_cell->i;
+      msg.j = ptr_cell->j;
+      msg.gptr = ptr_cell->_gstorage;
+      msg.storage_size = ptr_cell->_storage_size;
+      msg.nnz = ptr_cell->nnz();
+      msg.nblocks = ptr_cell->nblocks();
+      msg.width = std::get<0>(ptr_cell->_dims);
+      msg.meta = meta;
+      msg.gpu_block = gpu_block;
+      msg.targets.assign(tgt_cells.begin(),tgt_cells.end());
+      if ( !gpu_block && this->send_eager_(ptr_cell,pdest) ) {
+        msg.payload.assign(ptr_cell->_storage,ptr_cell->_storage+ptr_cell->_storage_size);
+      }
+      size_t bytes = sizeof(cell_notification_t) + msg.targets.size()*sizeof(std::size_t) + msg.payload.size();
+      this->notifications_.post(pdest,std::move(msg),bytes);
+    }
 
-                bool found = false;
-                for (auto & block: tgt_cell.blocks()) {
-                  //Match found if row between first and last row of block
-                  if ( block.first_row <= row && row < block.first_row + tgt_cell.block_nrows(block) ) {
-                    //Offset is block offset + row index in block & number of cols in tgt_cell
-                    auto offset = block.offset + (row - block.first_row)*tgt_cell.width() + (col-fc);
-                    tgt_cell._nzval[offset] = nzvalA[rowidx-1];
-                    found = true;
-                    break;
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::receive_cell_( cell_notification_t & msg ) {
+      switch ( msg.op ) {
+        case Factorization::op_type::FACTOR:
+          this->receive_factor_cell_(msg);
+          break;
+        case Factorization::op_type::TRSM:
+          this->receive_trsm_cell_(msg);
+          break;
+        case Factorization::op_type::UPDATE2D_COMP:
+          this->receive_update_cell_(msg);
+          break;
+        default:
+          bassert(false);
+          break;
+      }
+    }
 
-                  }  
-                }
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::receive_cell_data_( SparseTask2D::data_t & data, std::vector<char> & payload ) {
+      if ( !payload.empty() ) {
+        this->scheduler.receive_eager(data,payload.begin(),payload.end());
+      }
+#ifdef _EAGER_FETCH_
+      else {
+        this->scheduler.eager_fetch(data);
+      }
+#endif
+    }
 
-                bassert(found);
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::receive_factor_cell_( cell_notification_t & msg ) {
+#ifdef _TIMING_
+      gasneti_tick_t start = gasneti_ticks_now();
+#endif
+      auto matptr = this;
+      auto I = std::get<1>(msg.meta);
+      rowind_t fc = this->Xsuper_[I-1];
+      rowind_t width = msg.width;
+      size_t nnz = msg.nnz;
+      size_t nblocks = msg.nblocks;
+
+      //store pointer & associated metadata somewhere
+      std::shared_ptr <SparseTask2D::data_t > data;
+      std::shared_ptr <SparseTask2D::data_t > diag_data;
+
+      for ( auto & tgt_cell_idx: msg.targets ) {
+        auto taskptr = this->task_graph[tgt_cell_idx].get();
+
+        if ( std::get<2>(taskptr->_meta) == Factorization::op_type::DLT2D_COMP
+            || std::get<2>(taskptr->_meta) == Factorization::op_type::UPDATE2D_COMP
+           ) {
+          bassert(std::get<2>(taskptr->_meta) == Factorization::op_type::DLT2D_COMP);
+          bassert (this->options_.decomposition == DecompositionType::LDL);
+          if ( !diag_data ) {
+            upcxx::global_ptr<char> diag_ptr = this->find_diag_pointer( I );
+            bassert ( diag_ptr.where() != upcxx::rank_me() );
+            diag_data = std::make_shared<SparseTask2D::data_t >();
+            diag_data->in_meta = std::make_tuple(I,I,Factorization::op_type::DIAG_ENTRIES,0,0);
+            diag_data->size = (this->Xsuper_[I] - this->Xsuper_[I-1])*sizeof(T);
+            diag_data->remote_gptr = diag_ptr;
+          }
 
-              }
-              
+          taskptr->input_msg.push_back(diag_data);
+          diag_data->target_tasks.push_back(taskptr);
+          taskptr->avail_dep(1,this->scheduler);
+        } else {
+          if ( ! data ) {
+            data = std::make_shared<SparseTask2D::data_t >();
+            data->in_meta = msg.meta;
+            data->size = msg.storage_size;
+            data->remote_gptr = msg.gptr;
+#ifdef CUDA_MODE
+            if (msg.gpu_block) {
+              data->is_gpu_block = true;
+              data->d_size = nnz;
             }
+#endif
           }
-
+          taskptr->input_msg.push_back(data);
+          data->target_tasks.push_back(taskptr);
+          taskptr->avail_dep(1,this->scheduler);
         }
-        
+      }
+
+      if ( data ) {
+        data->on_fetch_future = data->on_fetch_future.then(
+            [fc,width,nnz,nblocks,I,matptr,data](SparseTask2D::data_t * pdata) {
+#if not defined(_NO_COMPUTATION_)
+            //create snodeBlock_t and store it in the extra_data
+            if (matptr->options_.decomposition == DecompositionType::LDL) {
+              pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
+            }
+            else {
+#ifdef CUDA_MODE
+              if (data->is_gpu_block) {
+                pdata->extra_data = std::shared_ptr<blockCellBase_t>( 
+                (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,pdata->d_landing_zone,fc,width,nnz,nblocks) );
+              } else {
+                pdata->extra_data = std::shared_ptr<blockCellBase_t>( 
+                (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
+              }
+#else
+              pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(I,I,pdata->landing_zone,fc,width,nnz,nblocks) );
+#endif
+            }
+#endif
+            return upcxx::to_future(pdata);
+            });
+        this->receive_cell_data_(*data,msg.payload);
+      }
 
+#ifdef _EAGER_FETCH_
+      if ( diag_data ) {
+        this->scheduler.eager_fetch(*diag_data);
       }
+#endif
 
+#ifdef _TIMING_
+      this->rpc_fact_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
+#endif
+    }
 
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::receive_trsm_cell_( cell_notification_t & msg ) {
+#ifdef _TIMING_
+      gasneti_tick_t start = gasneti_ticks_now();
+#endif
+      auto matptr = this;
+      Int K = msg.i;
+      Int I = msg.j;
+      rowind_t width = msg.width;
+      size_t nnz = msg.nnz;
+      size_t nblocks = msg.nblocks;
+
+      //store pointer & associated metadata somewhere
+      auto data = std::make_shared<SparseTask2D::data_t >();
+      data->in_meta = msg.meta;
+      data->size = msg.storage_size;
+      data->remote_gptr = msg.gptr;
+
+      for ( auto & tgt_cell_idx: msg.targets ) {
+        auto taskptr = this->task_graph[tgt_cell_idx].get();
+
+        bassert( std::get<2>(taskptr->_meta)==Factorization::op_type::DLT2D_COMP
+            || std::get<2>(taskptr->_meta)==Factorization::op_type::UPDATE2D_COMP);
+
+        taskptr->input_msg.push_back(data);
+        data->target_tasks.push_back(taskptr);
+        taskptr->avail_dep(1,this->scheduler);
+      }
 
+      auto owner = msg.gptr.where();
+      rowind_t fc = this->Xsuper_[I-1];
+      data->on_fetch_future = data->on_fetch_future.then(
+          [fc,matptr,width,nnz,nblocks,K,I,owner](SparseTask2D::data_t * pdata) {
+#if not defined(_NO_COMPUTATION_)
+          //create snodeBlock_t and store it in the extra_data
+          if (matptr->options_.decomposition == DecompositionType::LDL) {
+            pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(K,I,pdata->landing_zone,fc,width,nnz,nblocks) );
+          }
+          else {
+            pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(K,I,pdata->landing_zone,fc,width,nnz,nblocks) );
+          }
 
+          pdata->extra_data->owner = owner;
+#endif
+          return upcxx::to_future(pdata); 
+          }
+          );
+      this->receive_cell_data_(*data,msg.payload);
 
+#ifdef _TIMING_
+      this->rpc_trsm_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
+#endif
+    }
 
+  template <typename colptr_t, typename rowind_t, typename T, typename int_t>
+    void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::receive_update_cell_( cell_notification_t & msg ) {
+#ifdef _TIMING_
+      gasneti_tick_t start = gasneti_ticks_now();
+#endif
+      auto matptr = this;
+      Int K = msg.i;
+      Int J = msg.j;
+      rowind_t width = msg.width;
+      size_t nnz = msg.nnz;
+      size_t nblocks = msg.nblocks;
+
+      //store pointer & associated metadata somewhere
+      auto data = std::make_shared<SparseTask2D::data_t >();
+      data->in_meta = msg.meta;
+      data->size = msg.storage_size;
+      data->remote_gptr = msg.gptr;
+
+      for ( auto & tgt_cell_idx: msg.targets ) {
+        auto taskptr = this->task_graph[tgt_cell_idx].get();
+        taskptr->input_msg.push_back(data);
+        data->target_tasks.push_back(taskptr);
+        taskptr->avail_dep(1,this->scheduler);
+      }
 
-    } 
+      auto I = std::get<1>(msg.meta);
+      rowind_t fc = this->Xsuper_[I-1];
+      data->on_fetch_future = data->on_fetch_future.then(
+          [fc,width,nnz,nblocks,K,J,matptr](SparseTask2D::data_t * pdata) {
+#if not defined(_NO_COMPUTATION_)
+          //create snodeBlock_t and store it in the extra_data
+          if (matptr->options_.decomposition == DecompositionType::LDL) {
+            pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlockLDL_t(K,J,pdata->landing_zone,fc,width,nnz,nblocks) );
+          }
+          else {
+            pdata->extra_data = std::shared_ptr<blockCellBase_t>( (blockCellBase_t*)new snodeBlock_t(K,J,pdata->landing_zone,fc,width,nnz,nblocks) );
+          }
+#endif
+          return upcxx::to_future(pdata);
+          }
+          );
+      this->receive_cell_data_(*data,msg.payload);
+
+#ifdef _TIMING_
+      this->rpc_upd_ticks += gasneti_ticks_to_ns(gasneti_ticks_now() - start);
+#endif
+    }
 
   template <typename colptr_t, typename rowind_t, typename T, typename int_t>
     void symPACKMatrix2D<colptr_t,rowind_t,T,int_t>::Factorize( ) {
@@ -6599,6 +7921,10 @@ namespace symPACK{
           else if (type == Factorization::op_type::DLT2D_COMP) {
             return false;
           }
+          else if (type == Factorization::op_type::SUBTREE2D) {
+            //nobody else touches the cells of a subtree before it is done
+            return false;
+          }
           else {
             auto src = std::get<0>(pTask->_meta);
             auto J = std::get<1>(pTask->_meta);
@@ -6622,7 +7948,28 @@ namespace symPACK{
 #ifdef _TIMING_
       std::chrono::high_resolution_clock::time_point t3 = std::chrono::high_resolution_clock::now();
 #endif
+      //each execute consumes the dependency counters: the graph is re-armed on every
+      //rank before any of them may notify its tasks
+      this->reset_task_graph_(this->task_graph);
+      upcxx::barrier();
+      //notifications of the produced cells are batched per destination
+      this->scheduler.runTaskHandle_ = [this](SparseTask2D * ptask) { this->run_task_(ptask); };
+      this->scheduler.batchKeyHandle_ = nullptr;
+      this->scheduler.runBatchHandle_ = nullptr;
+      if ( this->options_.batch_width > 0 && this->options_.batch_size > 1 ) {
+        this->scheduler.batchKeyHandle_ = [this](SparseTask2D * ptask) { return this->batch_key_(ptask); };
+        this->scheduler.runBatchHandle_ = [this](SparseTask2D ** tasks, int count) { this->run_batch_(tasks,count); };
+      }
+      else if ( this->options_.batch_width > 0 ) {
+        logfileptr->OFS()<<"batch_width ignored: batch_size is "<<this->options_.batch_size<<std::endl;
+      }
+      this->notifications_.reset_stats();
+      this->scheduler.progressHandle_ = [this](bool idle) { this->notifications_.tick(idle); };
       this->scheduler.execute(this->task_graph,this->mem_budget);
+      this->scheduler.progressHandle_ = nullptr;
+      if ( this->options_.aggregate_bytes > 0 ) {
+        this->notifications_.print_stats(logfileptr->OFS(),"Cell notifications");
+      }
 #ifdef _TIMING_
       std::chrono::high_resolution_clock::time_point t4 = std::chrono::high_resolution_clock::now();
       double execute_graph_ticks = std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count();
@@ -6648,6 +7995,20 @@ namespace symPACK{
       this->solve_data.nrhs = nrhs;
       this->solve_data.contribs.clear();
       this->solve_data.contribs.resize(nsuper+1);
+      if ( this->options_.cell_arena ) {
+        //the contributions of the previous solve have been released
+        this->solve_arena_.clear();
+        if ( this->solve_arena_.capacity() == 0 ) {
+          //the contributions of the local diagonal cells, others are added as needed
+          size_t bytes = 0;
+          for (auto & ptr_cell: this->localBlocks_) {
+            if ( ptr_cell->i == ptr_cell->j ) {
+              bytes += cell_arena_t::padded( (ptr_cell->total_rows()+1)*nrhs*sizeof(T) + ptr_cell->nblocks()*sizeof(typename snodeBlock_t::block_t) );
+            }
+          }
+          this->solve_arena_.reserve(bytes,std::max(bytes,(size_t)1<<20));
+        }
+      }
       delete [] this->solve_data.contribs_lock;
       this->solve_data.contribs_lock = new std::atomic<bool>[this->nsuper+1];
       for ( int i = 0; i < this->nsuper+1; i++ ) { this->solve_data.contribs_lock[i] = false; } 
@@ -6705,8 +8066,16 @@ namespace symPACK{
       }
 #endif
 
+      //each execute consumes the dependency counters, see Factorize
+      this->reset_task_graph_(this->task_graph_solve);
       upcxx::barrier();
+      this->scheduler.runTaskHandle_ = [this](SparseTask2D * ptask) { this->run_task_(ptask); };
+      this->scheduler.batchKeyHandle_ = nullptr;
+      this->scheduler.runBatchHandle_ = nullptr;
       this->scheduler.execute(this->task_graph_solve,this->mem_budget);
+      if ( this->options_.cell_arena ) {
+        this->solve_arena_.print_stats(logfileptr->OFS(),"Solve arena");
+      }
   } 
 
   template <typename colptr_t, typename rowind_t, typename T, typename int_t>
@@ -6725,11 +8094,11 @@ namespace symPACK{
 
           if ( iOwner == this->iam ) {
             auto & contrib_slot = this->solve_data.contribs[I];
-            auto & ptr_tgt_cell = std::get<1>(contrib_slot);
-            bassert(ptr_tgt_cell!=nullptr);
-            auto & tgt_cell = *std::dynamic_pointer_cast<snodeBlock_t>(ptr_tgt_cell);
+            auto ptr_contrib = std::get<1>(contrib_slot).get();
+            bassert(ptr_contrib!=nullptr);
+            auto & tgt_cell = *ptr_contrib;
             if (this->options_.decomposition == DecompositionType::LDL) {
-              auto & tgt_ldlcell = *std::dynamic_pointer_cast<snodeBlockLDL_t>(ptr_tgt_cell);
+              auto & tgt_ldlcell = *(snodeBlockLDL_t*)ptr_contrib;
               bassert(tgt_ldlcell.scaled);
             }
 
@@ -6768,8 +8137,7 @@ namespace symPACK{
         Int src_last_col = this->Xsuper_[I]-1;
 
         for (Int J=I;J<this->Xsuper_.size();J++) {
-          auto idx = coord2supidx(J-1,I-1);
-          if (this->cells_.find(idx)!= this->cells_.end()) {
+          if (pQueryCELL(J-1,I-1) != nullptr) {
 
 
             auto ptr_tgt_cell = pQueryCELL(J-1,I-1);
@@ -6778,7 +8146,7 @@ namespace symPACK{
 
             Int iOwner = ptr_tgt_cell->owner;
             if ( iOwner == this->iam ) {
-              auto & tgt_cell = *std::dynamic_pointer_cast<snodeBlock_t>(ptr_tgt_cell);
+              auto & tgt_cell = *pQueryCELL2(J-1,I-1);
               for (auto & block: tgt_cell.blocks()) {
                 T * val = &tgt_cell._nzval[block.offset];
                 Int nRows = tgt_cell.block_nrows(block);
@@ -6800,12 +8168,11 @@ namespace symPACK{
         Int src_last_col = this->Xsuper_[I]-1;
 
         for (Int J=I;J<this->Xsuper_.size();J++) {
-          auto idx = coord2supidx(J-1,I-1);
-          if (this->cells_.find(idx)!= this->cells_.end()) {
+          if (pQueryCELL(J-1,I-1) != nullptr) {
             auto ptr_tgt_cell = pQueryCELL(J-1,I-1);
             Int iOwner = ptr_tgt_cell->owner;
             if ( iOwner == this->iam ) {
-              auto & tgt_cell = *std::dynamic_pointer_cast<snodeBlock_t>(ptr_tgt_cell);
+              auto & tgt_cell = *pQueryCELL2(J-1,I-1);
               for (auto & block: tgt_cell.blocks()) {
                 T * val = &tgt_cell._nzval[block.offset];
                 Int nRows = tgt_cell.block_nrows(block);
@@ -6828,13 +8195,11 @@ namespace symPACK{
         Int src_last_col = this->Xsuper_[I]-1;
 
         for (Int J=I;J<this->Xsuper_.size();J++) {
-          auto idx = coord2supidx(J-1,I-1);
-          auto it = this->cells_.end();
-          if ( (it = this->cells_.find(idx)) != this->cells_.end()) {
+          if (pQueryCELL(J-1,I-1) != nullptr) {
             auto ptr_tgt_cell = pQueryCELL(J-1,I-1);
             Int iOwner = ptr_tgt_cell->owner;
             if ( iOwner == this->iam ) {
-              auto & tgt_cell = *std::dynamic_pointer_cast<snodeBlock_t>(ptr_tgt_cell);
+              auto & tgt_cell = *pQueryCELL2(J-1,I-1);
               for (auto & block: tgt_cell.blocks()) {
                 T * val = &tgt_cell._nzval[block.offset];
                 auto nRows = tgt_cell.block_nrows(block);
@@ -6868,27 +8233,216 @@ namespace symPACK{
   namespace scheduling {
 #ifdef SP_THREADS
     template <typename ttask_t , typename ttaskgraph_t >
-      inline bool Scheduler2D<ttask_t,ttaskgraph_t>::assignWork(ttask_t * ptask) 
+      inline void Scheduler2D<ttask_t,ttaskgraph_t>::release_lock_( typename ttask_t::lock_t * lock_ptr )
       {
-        if ( ! free_workers_.empty() ) {
-          auto id = free_workers_.front();
-          auto & w_p = work_pointers_[id];
-          bool success = w_p.set(ptask);
-          if ( success ) {
-            bassert(worker_loads_[id]<2);
-            ++worker_loads_[id]; 
-            if ( worker_loads_[id] == 2 ) {
-              free_workers_.pop_front();
-              bassert(std::find(this->free_workers_.begin(),this->free_workers_.end(),id)==this->free_workers_.end());
-            }
-          }
-          return success;
+        std::lock_guard<std::mutex> lock(this->delayed_mutex_);
+        auto it = this->delayedTasks_.find(lock_ptr);
+        if ( it == this->delayedTasks_.end() ) return;
+        auto & task_slot = it->second;
+        //get the oldest delayed task waiting on that lock
+        auto nt = task_slot.front();
+        bassert(nt);
+        bassert(nt->_lock_ptr== lock_ptr);
+        //check if task needs to be delayed: this will also take the lock if no delay is required
+        if ( !this->extraTaskHandle_(nt) ) {
+          task_slot.pop_front();
+          this->pool_.push(nt);
+        }
+        //if the list is empty, then there is no point in having it in delayed tasks anymore
+        if ( task_slot.empty() ) {
+          this->delayedTasks_.erase(it);
+        }
+      }
+#endif
+
+    template <typename ttask_t , typename ttaskgraph_t >
+      inline void Scheduler2D<ttask_t,ttaskgraph_t>::run_batch_( std::vector<ttask_t*> & batch )
+      {
+        if ( batch.size() > 1 && this->runBatchHandle_ != nullptr ) {
+          this->runBatchHandle_(batch.data(),batch.size());
+          this->batch_cnt_++;
+          this->batched_tasks_ += batch.size();
         }
         else {
-          return false;
+          for (auto ptask: batch) { this->runTaskHandle_(ptask); }
+        }
+      }
+
+    template <typename ttask_t , typename ttaskgraph_t >
+      inline void Scheduler2D<ttask_t,ttaskgraph_t>::pop_ready_batch_( std::vector<ttask_t*> & batch )
+      {
+        batch.clear();
+        ttask_t * ptask = top_ready();
+        pop_ready();
+        batch.push_back(ptask);
+        int key = this->batch_key_(ptask);
+        if ( key < 0 ) return;
+        while ( (int)batch.size() < this->batch_size_ && !ready_tasks.empty() ) {
+          ptask = top_ready();
+          if ( this->batch_key_(ptask) != key ) break;
+          pop_ready();
+          batch.push_back(ptask);
+        }
+      }
+
+    template <typename ttask_t , typename ttaskgraph_t >
+      inline void Scheduler2D<ttask_t,ttaskgraph_t>::push_ready_task( ttask_t * ptask )
+      {
+#ifdef SP_THREADS
+        if ( this->extraTaskHandle_ != nullptr ) {
+          //taking the cell lock and queuing on it must be atomic w.r.t. release_lock_
+          std::lock_guard<std::mutex> lock(this->delayed_mutex_);
+          if ( this->extraTaskHandle_(ptask) ) {
+            this->delayedTasks_[ptask->_lock_ptr].push_back(ptask);
+            return;
+          }
         }
+        if ( this->on_worker() ) {
+          this->pool_.push(ptask);
+          return;
+        }
+        //the ready heap belongs to the master persona
+        if ( !upcxx::master_persona().active_with_caller() ) {
+          upcxx::master_persona().lpc_ff( [this,ptask]() { push_ready(this,ptask); } );
+          this->wake_master_();
+          return;
+        }
+#endif
+        push_ready(this,ptask);
+        //also ends the wait of a round in which an rpc made this task ready
+        this->wake_master_();
       }
+
+    template <typename ttask_t , typename ttaskgraph_t >
+      inline void Scheduler2D<ttask_t,ttaskgraph_t>::push_avail_task( ttask_t * ptask )
+      {
+#ifdef SP_THREADS
+        //the avail heap belongs to the master persona
+        if ( !upcxx::master_persona().active_with_caller() ) {
+          upcxx::master_persona().lpc_ff( [this,ptask]() { push_avail(this,ptask); } );
+          this->wake_master_();
+          return;
+        }
 #endif
+        push_avail(this,ptask);
+        this->wake_master_();
+      }
+
+    template <typename ttask_t , typename ttaskgraph_t >
+      inline void Scheduler2D<ttask_t,ttaskgraph_t>::idle_round_( bool busy )
+      {
+        auto now = std::chrono::steady_clock::now();
+        if ( busy ) {
+          if ( this->idle_rounds_ > 0 ) {
+            this->idle_time_ += std::chrono::duration<double>(now - this->idle_start_).count();
+          }
+          this->idle_rounds_ = 0;
+          this->idle_wait_us_ = 1;
+          this->idle_seen_ = this->idle_signals_.load();
+          return;
+        }
+        if ( this->idle_rounds_++ == 0 ) this->idle_start_ = now;
+        if ( this->idle_backoff_ && this->idle_rounds_ > idle_spin_rounds ) {
+          std::unique_lock<std::mutex> lock(this->idle_mutex_);
+          //a task handed over before idle_waiting_ is set is seen by the predicate
+          this->idle_waiting_ = true;
+          this->idle_cv_.wait_for(lock,std::chrono::microseconds(this->idle_wait_us_),
+              [this]() { return this->idle_signals_.load() != this->idle_seen_; });
+          this->idle_waiting_ = false;
+          this->idle_seen_ = this->idle_signals_.load();
+          this->idle_wait_us_ = std::min(2*this->idle_wait_us_,(int)idle_max_wait_us);
+        }
+      }
+
+    template <typename ttask_t , typename ttaskgraph_t >
+      inline void Scheduler2D<ttask_t,ttaskgraph_t>::allocate_landing_zone( data_t & msg, bool allow_view )
+      {
+        msg.allocate( this->lz_pool_.capacity() > 0 ? &this->lz_pool_ : nullptr, allow_view );
+        if ( msg.is_view ) {
+          this->local_view_cnt_++;
+          this->local_view_bytes_ += msg.size;
+        }
+        else {
+          msg.mem_counter = &this->lz_bytes_;
+          int64_t bytes = (this->lz_bytes_ += msg.size);
+          this->lz_peak_bytes_ = std::max(this->lz_peak_bytes_,bytes);
+        }
+      }
+
+    template <typename ttask_t , typename ttaskgraph_t >
+      inline void Scheduler2D<ttask_t,ttaskgraph_t>::start_fetch( data_t & msg )
+      {
+        if ( msg.landing_zone == nullptr ) {
+          this->allocate_landing_zone(msg,this->local_views_);
+        }
+        if ( !msg.transfered ) {
+          this->fetches_in_flight_++;
+          msg.fetch().then([this](data_t * pmsg) { this->fetches_in_flight_--; });
+        }
+      }
+
+    template <typename ttask_t , typename ttaskgraph_t >
+      inline void Scheduler2D<ttask_t,ttaskgraph_t>::fetch_inputs( ttask_t * ptask )
+      {
+        for (auto & msg : ptask->input_msg) {
+          this->start_fetch(*msg);
+          msg->fetch().then([this,ptask](data_t * pmsg) {
+              //ptask is pushed to the ready tasks once its counter reaches 0
+              ptask->satisfy_dep(1,*this);
+              });
+        }
+      }
+
+    //Fetches the inputs of available tasks as long as the landing zones fit in the
+    //memory budget. Tasks that do not fit are postponed, and once memory is released
+    //the postponed tasks that become ready with their fetch go first.
+    //If nothing else can make progress, one fetch is allowed to exceed the budget.
+    template <typename ttask_t , typename ttaskgraph_t >
+      inline void Scheduler2D<ttask_t,ttaskgraph_t>::process_avail( bool idle )
+      {
+        bool fetched = false;
+        if ( !this->deferred_avail_.empty() ) {
+          for (int pass = 0; pass < 2; pass++) {
+            for (auto it = this->deferred_avail_.begin(); it != this->deferred_avail_.end(); ) {
+              auto ptask = *it;
+              if ( (pass == 1 || this->fetch_unblocks(ptask)) && this->fits_budget(this->pending_fetch_bytes(ptask)) ) {
+                this->fetch_inputs(ptask);
+                fetched = true;
+                it = this->deferred_avail_.erase(it);
+              }
+              else {
+                it++;
+              }
+            }
+          }
+        }
+
+        while (!avail_tasks.empty()) {
+          auto ptask = top_avail();
+          pop_avail();
+          //inputs received eagerly skip the budget, there is nothing left to fetch
+          if ( this->inputs_received(ptask)
+              || (this->deferred_avail_.empty() && this->fits_budget(this->pending_fetch_bytes(ptask))) ) {
+            this->fetch_inputs(ptask);
+            fetched = true;
+          }
+          else {
+            this->deferred_avail_.push_back(ptask);
+          }
+        }
+
+        //wait one more round so that pending local dependencies are delivered
+        bool stalled = !fetched && idle && this->fetches_in_flight_ == 0 && !this->deferred_avail_.empty();
+        this->stalled_rounds_ = stalled ? this->stalled_rounds_+1 : 0;
+        if ( this->stalled_rounds_ > 1 ) {
+          this->stalled_rounds_ = 0;
+          auto it = std::find_if(this->deferred_avail_.begin(),this->deferred_avail_.end(),
+              [this](ttask_t * ptask) { return this->fetch_unblocks(ptask); });
+          if ( it == this->deferred_avail_.end() ) it = this->deferred_avail_.begin();
+          this->fetch_inputs(*it);
+          this->deferred_avail_.erase(it);
+        }
+      }
 
     template <typename ttask_t , typename ttaskgraph_t >
       inline void Scheduler2D<ttask_t,ttaskgraph_t>::execute(ttaskgraph_t & task_graph, double & mem_budget )
@@ -6901,242 +8455,137 @@ namespace symPACK{
         double ifempty_ticks = 0;
         try{
           int64_t local_task_cnt;
+          this->mem_budget_ = mem_budget;
+          this->lz_peak_bytes_ = this->lz_bytes_;
+          this->deferred_avail_.clear();
+          this->stalled_rounds_ = 0;
+          this->local_view_cnt_ = 0;
+          this->local_view_bytes_ = 0;
+          this->eager_cnt_ = 0;
+          this->eager_bytes_ = 0;
+          this->idle_time_ = 0.0;
+          this->idle_workers_ = false;
+          this->idle_rounds_ = 0;
+          this->idle_seen_ = this->idle_signals_.load();
+          this->batch_cnt_ = 0;
+          this->batched_tasks_ = 0;
+          this->idle_wait_us_ = 1;
           {
             local_task_cnt = task_graph.size();
             for (auto it = task_graph.begin(); it != task_graph.end(); it++) {
               auto & ptask = *it;
-              auto remote_deps = ptask->in_remote_dependencies_cnt;
               auto ptr = ptask.get();
-
-#ifdef _USE_PROM_AVAIL_
-              auto fut_comm = ptask->in_avail_prom.finalize();
-              if (remote_deps >0 ) {
-                fut_comm.then([this,ptr]() {
-                    push_avail(this,ptr);
-                    });
-              }
-#else
-              if (remote_deps >0 ) {
-                if (ptr->in_avail_counter == 0 ) {
-                  push_avail(this,ptr);
-                }
+              //other tasks are pushed once their counters reach 0, possibly
+              //before execute is called if a remote rank is already running
+              if ( ptr->in_remote_dependencies_cnt + ptr->in_local_dependencies_cnt == 0 ) {
+                this->push_ready_task(ptr);
               }
-#endif
-
-#ifdef _USE_PROM_RDY_
-              auto fut = ptask->in_prom.finalize();
-              fut.then([this, ptr]() {
-#ifdef SP_THREADS
-                  if (this->extraTaskHandle_!=nullptr) {
-                  bool delay = this->extraTaskHandle_(ptr);
-                  if (delay) {
-                  this->delayedTasks_[ptr->_lock_ptr].push_back(ptr);
-                  return;
-                  }
-                  }
-#endif
-                  push_ready(this,ptr);
-                  });
-#else
-              if (ptr->in_counter == 0 ) {
-#ifdef SP_THREADS
-                if (this->extraTaskHandle_!=nullptr) {
-                  bool delay = this->extraTaskHandle_(ptr);
-                  if (delay) {
-                    this->delayedTasks_[ptr->_lock_ptr].push_back(ptr);
-                  }
-                  else 
-                  {
-                    push_ready(this,ptr);
-                  }
-                } else 
-#endif
-                {
-                  push_ready(this,ptr);
-                }
-              }
-#endif
             }
           }
 
 #ifdef SP_THREADS
-          if (Multithreading::NumThread>1) {
-            std::atomic<bool> done(false);
+          //with a progress thread, a single compute thread runs the tasks on a
+          //worker while the master thread only drives UPC++ progress
+          if (Multithreading::NumThread>1 || this->progress_thread_) {
             int nthreads = std::max(1,Multithreading::NumThread-1);
-            this->work_pointers_ = std::vector<worker_ptrs<ttask_t>>(nthreads);
-
-            std::vector<std::thread> workers;
-            workers.reserve(nthreads);
-
-            this->free_workers_.clear();
-            this->worker_loads_.clear();
-            this->worker_loads_.resize(nthreads,0);
-            for (int count {0}; count < nthreads; count += 1) {
-              bassert(std::find(this->free_workers_.begin(),this->free_workers_.end(),count)==this->free_workers_.end());
-              this->free_workers_.push_back(count);
-            }
-
-            for (int count {0}; count < nthreads; count += 1) {
-              workers.emplace_back(
-                  [this,&done](int tid) {
-                  if (this->threadInitHandle_!=nullptr) {
-                  this->threadInitHandle_();
+            //the workers run the tasks, the master thread only submits the tasks
+            //made ready by communications and makes progress
+            std::atomic<int64_t> remaining_tasks(local_task_cnt);
+            //creates the workers on the first call only
+            this->pool_.start(nthreads,this->threadInitHandle_,this->pin_threads_,upcxx::local_team().rank_me());
+            this->pool_.set_backoff(this->idle_backoff_);
+            this->pool_.set_nested(this->nested_flops_);
+            this->pool_.begin(
+                [this,&remaining_tasks](ttask_t * t) {
+                  //t heads the batch chained by the master, which grows with the
+                  //tasks of the same kind this worker made ready last
+                  static thread_local std::vector<ttask_t*> batch;
+                  batch.clear();
+                  for (auto ptask = t; ptask != nullptr; ptask = ptask->batch_next) { batch.push_back(ptask); }
+                  int key = this->batch_key_(t);
+                  while ( key >= 0 && (int)batch.size() < this->batch_size_ ) {
+                    auto ptask = this->pool_.pop_own_if([this,key](ttask_t * next) { return this->batch_key_(next) == key; });
+                    if ( ptask == nullptr ) break;
+                    batch.push_back(ptask);
                   }
-                  auto & w_p = this->work_pointers_[tid];
-
-                  bool local_done = false;
-                  int drain = 0;
-                  while (true) {
-                  ttask_t * t = w_p.get();
-                  while (t!=nullptr) { 
-                  t->execute();
-                  auto lock_ptr = t->_lock_ptr;
-                  t->reset();
-
-                  int J=std::get<0>(t->_meta);
-                  int I=std::get<1>(t->_meta);
-                  upcxx::master_persona().lpc_ff( 
-                      [this,tid,I,J,lock_ptr] () {
-                      // if _lock_ptr is not null, it means that t had to acquire a lock,
-                      // which means it may have to unlock other tasks
-                      if ( lock_ptr ) {
+                  this->run_batch_(batch);
+                  for (auto ptask: batch) {
+                    auto lock_ptr = ptask->_lock_ptr;
+                    ptask->reset();
+                    // if _lock_ptr is not null, it means that ptask had to acquire a lock,
+                    // which means it may have to unlock other tasks
+                    if ( lock_ptr ) {
                       bassert(this->extraTaskHandle_!=nullptr);
-                      auto & task_slot = this->delayedTasks_[lock_ptr];
-                      if ( ! task_slot.empty() ) {
-                      //get the oldest delayed task waiting on that lock
-                      auto nt = task_slot.front();
-                      bassert(nt);
-                      bassert(nt->_lock_ptr== lock_ptr);
-                      //check if task needs to be delayed: this will also take the lock if no delay is required
-                      bool delay = extraTaskHandle_(nt);
-                      if (!delay) {
-                      //remove it from the list of delayed tasks
-                      task_slot.pop_front();
-                      //push it in the list of ready tasks
-                      push_ready(this, nt );
-                      }
-                      }
-                      //if the list is empty, then there is no point in having it in delayed tasks anymore
-                      if ( task_slot.empty() ) {
-                        this->delayedTasks_.erase(lock_ptr);
-                      }
-                      }
-
-                      //decrement the load of that worker
-                      bassert(this->worker_loads_[tid]>=1);
-                      if (--this->worker_loads_[tid]==1) {
-                        bassert(std::find(this->free_workers_.begin(),this->free_workers_.end(),tid)==this->free_workers_.end());
-                        this->free_workers_.push_back(tid);
-                      }
-                      else {
-                        bassert(std::find(this->free_workers_.begin(),this->free_workers_.end(),tid)!=this->free_workers_.end());
-                      }
-                      });
-                  t = w_p.get();
-                  }
-
-                  if (done.load(std::memory_order_acquire) ) {
-                    break;
-                  }
-                  else {
-                    sched_yield();
-                  }
-                  }
-                  }
-              , count);
-            }
-
-            while (local_task_cnt>0) {
-              bool empty = false;
-              while (!empty && !this->free_workers_.empty()) {
-                ttask_t * ptask = nullptr;
-                {
-                  empty = ready_tasks.empty();
-                  if (!empty) {
-                    ptask = top_ready();
-                  }
-                }
-
-                if (empty)
-                  break;
-
-                if (!empty) {
-                  bool delay = false;
-                  if (!delay) {
-                    if (assignWork(ptask)) {
-                      local_task_cnt--;
-                      pop_ready();
-                    }
-                    else {
-                      break;
+                      this->release_lock_(lock_ptr);
                     }
+                    if ( --remaining_tasks == 0 ) this->wake_master_();
                   }
-                }
+                });
+
+            std::vector<ttask_t*> batch;
+            while (remaining_tasks.load(std::memory_order_acquire)>0) {
+              bool busy = !ready_tasks.empty() || !avail_tasks.empty();
+              while (!ready_tasks.empty()) {
+                //a batch goes to a single worker as a chain of tasks
+                this->pop_ready_batch_(batch);
+                for (size_t pos = 1; pos < batch.size(); pos++) { batch[pos-1]->batch_next = batch[pos]; }
+                this->pool_.push(batch.front());
               }
 
+              bool idle = this->pool_.idle();
+              if ( this->progressHandle_ != nullptr ) this->progressHandle_(idle);
               upcxx::progress();
               sched_yield();
 
               //handle communications
-              empty = false;
-              while (!empty) {
-                ttask_t * ptask = nullptr;
-                {
-                  empty = avail_tasks.empty();
-
-                  if (!empty) {
-                    ptask = top_avail();
-                    pop_avail();
-                  }
-                }
-                if (!empty) {
-                  for (auto & msg : ptask->input_msg) {
-                    msg->allocate();
-                    msg->fetch().then([this,ptask](incoming_data_t<ttask_t,meta_t> * pmsg) {
-                        //fulfill promise by one, when this reaches 0, ptask is moved to scheduler.ready_tasks
-                        ptask->satisfy_dep(1,*this);
-                        });
-                  }
-                  upcxx::progress(upcxx::progress_level::internal);
-                }
+              if (!avail_tasks.empty() || !this->deferred_avail_.empty()) {
+                this->process_avail(idle);
+                upcxx::progress(upcxx::progress_level::internal);
               }
+              this->idle_round_(busy);
             }
+            this->idle_round_(true);
             upcxx::progress();
             upcxx::discharge();
-            done = true;
-            for (auto && thread: workers) thread.join();
+            this->pool_.end();
+            if ( this->progressHandle_ != nullptr ) this->progressHandle_(true);
             //ensure the last lpc_ff are executed;
             if ( this->quiesceHandle_ != nullptr ) this->quiesceHandle_();
             upcxx::progress();
             upcxx::barrier();
+            this->pool_.print_stats(logfileptr->OFS());
+            //the master only submits tasks and makes progress, its idle rounds say nothing about the load
+            this->idle_time_ = this->pool_.idle_time();
+            this->idle_workers_ = true;
           }
           else
 #endif
           {
+            std::vector<ttask_t*> batch;
             while (local_task_cnt>0) {
+              bool busy = !ready_tasks.empty() || !avail_tasks.empty();
               if (!ready_tasks.empty()) {
                 upcxx::progress(upcxx::progress_level::internal);
-                auto ptask = top_ready();
-                pop_ready();
-                ptask->execute(); 
-                local_task_cnt--;
+                //the small ready tasks of the same kind are run in a single call
+                this->pop_ready_batch_(batch);
+                this->run_batch_(batch);
+                for (auto ptask: batch) {
+                  //release the landing zones of the inputs
+                  ptask->reset();
+                  local_task_cnt--;
+                }
               }
+              if ( this->progressHandle_ != nullptr ) this->progressHandle_(ready_tasks.empty());
               upcxx::progress();
               //handle communications
-              if (!avail_tasks.empty()) {
-                //get all comms from a task
-                auto ptask = top_avail();
-                pop_avail();
-                for (auto & msg : ptask->input_msg) {
-                  msg->allocate();
-                  msg->fetch().then([this,ptask](incoming_data_t<ttask_t,meta_t> * pmsg) {
-                      //fulfill promise by one, when this reaches 0, ptask is moved to scheduler.ready_tasks
-                      ptask->satisfy_dep(1,*this);
-                      });
-                } 
+              if (!avail_tasks.empty() || !this->deferred_avail_.empty()) {
+                this->process_avail(ready_tasks.empty());
 	      	upcxx::progress(upcxx::progress_level::internal);
               }
+              this->idle_round_(busy);
             }
+            this->idle_round_(true);
+            if ( this->progressHandle_ != nullptr ) this->progressHandle_(true);
 	    upcxx::progress();
             upcxx::discharge();
 #ifdef SP_THREADS
@@ -7148,6 +8597,26 @@ namespace symPACK{
         catch(const std::runtime_error& e) {
           std::cerr << "Runtime error: " << e.what() << '\n';
         }
+
+        logfileptr->OFS()<<"Scheduler idle time: "<<this->idle_time_<<" s"<<(this->idle_workers_?" (workers)":"")<<(this->idle_backoff_?" (backoff)":"")<<std::endl;
+        if ( this->batch_cnt_ > 0 ) {
+          logfileptr->OFS()<<"Batches: "<<this->batch_cnt_<<" batches of "<<this->batched_tasks_<<" small tasks"<<std::endl;
+        }
+        else if ( this->batchKeyHandle_ != nullptr ) {
+          logfileptr->OFS()<<"Batches: none, no two small tasks of the same kind were ready together"<<std::endl;
+        }
+        if ( this->lz_pool_.capacity() > 0 ) {
+          this->lz_pool_.print_stats(logfileptr->OFS());
+        }
+        if ( this->local_views_ ) {
+          logfileptr->OFS()<<"Local views: "<<this->local_view_cnt_<<" cells read in place ("<<this->local_view_bytes_<<" bytes not copied)"<<std::endl;
+        }
+        if ( this->eager_cnt_ > 0 ) {
+          logfileptr->OFS()<<"Eager cells: "<<this->eager_cnt_<<" cells received inside rpcs ("<<this->eager_bytes_<<" bytes)"<<std::endl;
+        }
+        if ( this->mem_budget_ > 0 ) {
+          logfileptr->OFS()<<"Landing zones peak: "<<this->lz_peak_bytes_<<" bytes (budget "<<(int64_t)this->mem_budget_<<" bytes)"<<std::endl;
+        }
       }
   }
 
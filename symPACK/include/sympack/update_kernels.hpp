@@ -0,0 +1,491 @@
+#ifndef _SYMPACK_UPDATE_KERNELS_HPP_
+#define _SYMPACK_UPDATE_KERNELS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+
+#include "sympack/lapack.hpp"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace symPACK {
+
+  /// @namespace kernels
+  ///
+  /// @brief Small CPU kernels used by the 2D cell updates
+  namespace kernels {
+
+    //the fused update packs the pivot panel, it should stay in L1/L2
+    static const size_t fused_update_panel_limit = 32768;
+    //below this many flops the packing overhead is not worth it
+    static const size_t fused_update_min_flops = 64;
+
+    template <typename T>
+      inline bool use_fused_update( size_t m, size_t n, size_t k ) {
+        return n*k*sizeof(T) <= fused_update_panel_limit && 2*m*n*k >= fused_update_min_flops;
+      }
+
+    //packs the row-major n x k block B (leading dimension ldb) as Bt (k x n, leading dimension n)
+    template <typename T, typename int_t>
+      inline void pack_transpose( int_t n, int_t k, const T * B, int_t ldb, T * Bt ) {
+        for (int_t j = 0; j < n; ++j) {
+          const T * b = &B[j*ldb];
+          for (int_t l = 0; l < k; ++l) {
+            Bt[l*n+j] = b[l];
+          }
+        }
+      }
+
+    //C[row_offset[i]+col_offset[j]] -= sum_l A[i*lda+l] * Bt[l*ldb+j]
+    //for a sub block of at most MR x NR entries. This is the generic path.
+    template <int MR, int NR, typename T, typename int_t, typename offset_t>
+      inline void gemm_scatter_tile( int_t m, int_t n, int_t k, const T * A, int_t lda, const T * Bt, int_t ldb,
+          T * C, const offset_t * row_offset, const offset_t * col_offset ) {
+        T acc[MR][NR];
+        for (int_t i = 0; i < MR; ++i) { for (int_t j = 0; j < NR; ++j) { acc[i][j] = T(0); } }
+
+        if ( m == MR && n == NR ) {
+          for (int_t l = 0; l < k; ++l) {
+            const T * b = &Bt[l*ldb];
+            for (int_t i = 0; i < MR; ++i) {
+              T a = A[i*lda+l];
+              for (int_t j = 0; j < NR; ++j) { acc[i][j] += a * b[j]; }
+            }
+          }
+        }
+        else {
+          for (int_t l = 0; l < k; ++l) {
+            const T * b = &Bt[l*ldb];
+            for (int_t i = 0; i < m; ++i) {
+              T a = A[i*lda+l];
+              for (int_t j = 0; j < n; ++j) { acc[i][j] += a * b[j]; }
+            }
+          }
+        }
+
+        for (int_t i = 0; i < m; ++i) {
+          T * c = C + row_offset[i];
+          for (int_t j = 0; j < n; ++j) { c[col_offset[j]] -= acc[i][j]; }
+        }
+      }
+
+    //Generic fused GEMM + scatter:
+    //C[row_offset[i]+col_offset[j]] -= sum_l A[i*lda+l] * Bt[l*ldb+j]
+    //A is m x k row-major (the facing cell), Bt is k x n (the packed pivot cell)
+    template <typename T, typename int_t, typename offset_t>
+      inline void gemm_scatter( int_t m, int_t n, int_t k, const T * A, int_t lda, const T * Bt, int_t ldb,
+          T * C, const offset_t * row_offset, const offset_t * col_offset ) {
+        const int MR = 4;
+        const int NR = 8;
+        for (int_t i = 0; i < m; i += MR) {
+          int_t mr = std::min((int_t)MR, m-i);
+          for (int_t j = 0; j < n; j += NR) {
+            int_t nr = std::min((int_t)NR, n-j);
+            gemm_scatter_tile<MR,NR>(mr,nr,k,&A[i*lda],lda,&Bt[j],ldb,C,&row_offset[i],&col_offset[j]);
+          }
+        }
+      }
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+    //SIMD register abstraction for double precision, selected at compile time
+    class simd_double {
+      public:
+#if defined(__AVX512F__)
+        using reg_t = __m512d;
+        static const int width = 8;
+        static inline reg_t zero() { return _mm512_setzero_pd(); }
+        static inline reg_t set1( double a ) { return _mm512_set1_pd(a); }
+        static inline reg_t loadu( const double * p ) { return _mm512_loadu_pd(p); }
+        static inline void storeu( double * p, reg_t a ) { _mm512_storeu_pd(p,a); }
+        static inline reg_t fmadd( reg_t a, reg_t b, reg_t c ) { return _mm512_fmadd_pd(a,b,c); }
+        static inline reg_t sub( reg_t a, reg_t b ) { return _mm512_sub_pd(a,b); }
+#else
+        using reg_t = __m256d;
+        static const int width = 4;
+        static inline reg_t zero() { return _mm256_setzero_pd(); }
+        static inline reg_t set1( double a ) { return _mm256_set1_pd(a); }
+        static inline reg_t loadu( const double * p ) { return _mm256_loadu_pd(p); }
+        static inline void storeu( double * p, reg_t a ) { _mm256_storeu_pd(p,a); }
+#if defined(__FMA__)
+        static inline reg_t fmadd( reg_t a, reg_t b, reg_t c ) { return _mm256_fmadd_pd(a,b,c); }
+#else
+        static inline reg_t fmadd( reg_t a, reg_t b, reg_t c ) { return _mm256_add_pd(_mm256_mul_pd(a,b),c); }
+#endif
+        static inline reg_t sub( reg_t a, reg_t b ) { return _mm256_sub_pd(a,b); }
+#endif
+    };
+
+    //double precision fused GEMM + scatter using a 4 x (2*simd width) register tile
+    template <typename int_t, typename offset_t>
+      inline void gemm_scatter( int_t m, int_t n, int_t k, const double * A, int_t lda, const double * Bt, int_t ldb,
+          double * C, const offset_t * row_offset, const offset_t * col_offset ) {
+        using simd = simd_double;
+        using reg_t = simd::reg_t;
+        const int MR = 4;
+        const int W = simd::width;
+        const int NR = 2*W;
+
+        int_t m_full = m - m%MR;
+        int_t n_full = n - n%NR;
+
+        for (int_t j = 0; j < n_full; j += NR) {
+          //columns of the tile are contiguous in the target if their offsets are
+          bool contiguous = col_offset[j+NR-1] - col_offset[j] == NR-1;
+          for (int_t i = 0; i < m_full; i += MR) {
+            reg_t c00 = simd::zero(), c01 = simd::zero();
+            reg_t c10 = simd::zero(), c11 = simd::zero();
+            reg_t c20 = simd::zero(), c21 = simd::zero();
+            reg_t c30 = simd::zero(), c31 = simd::zero();
+            const double * a0 = &A[(i+0)*lda];
+            const double * a1 = &A[(i+1)*lda];
+            const double * a2 = &A[(i+2)*lda];
+            const double * a3 = &A[(i+3)*lda];
+            for (int_t l = 0; l < k; ++l) {
+              reg_t b0 = simd::loadu(&Bt[l*ldb+j]);
+              reg_t b1 = simd::loadu(&Bt[l*ldb+j+W]);
+              reg_t a;
+              a = simd::set1(a0[l]); c00 = simd::fmadd(a,b0,c00); c01 = simd::fmadd(a,b1,c01);
+              a = simd::set1(a1[l]); c10 = simd::fmadd(a,b0,c10); c11 = simd::fmadd(a,b1,c11);
+              a = simd::set1(a2[l]); c20 = simd::fmadd(a,b0,c20); c21 = simd::fmadd(a,b1,c21);
+              a = simd::set1(a3[l]); c30 = simd::fmadd(a,b0,c30); c31 = simd::fmadd(a,b1,c31);
+            }
+
+            reg_t acc[MR][2] = { {c00,c01}, {c10,c11}, {c20,c21}, {c30,c31} };
+            for (int ii = 0; ii < MR; ++ii) {
+              double * c = C + row_offset[i+ii];
+              if ( contiguous ) {
+                double * cj = c + col_offset[j];
+                simd::storeu(cj, simd::sub(simd::loadu(cj),acc[ii][0]));
+                simd::storeu(cj+W, simd::sub(simd::loadu(cj+W),acc[ii][1]));
+              }
+              else {
+                alignas(64) double tmp[NR];
+                simd::storeu(tmp,acc[ii][0]);
+                simd::storeu(tmp+W,acc[ii][1]);
+                for (int jj = 0; jj < NR; ++jj) { c[col_offset[j+jj]] -= tmp[jj]; }
+              }
+            }
+          }
+          //remaining rows
+          if ( m_full < m ) {
+            gemm_scatter_tile<MR,NR>(m-m_full,(int_t)NR,k,&A[m_full*lda],lda,&Bt[j],ldb,C,&row_offset[m_full],&col_offset[j]);
+          }
+        }
+
+        //remaining columns
+        if ( n_full < n ) {
+          for (int_t i = 0; i < m; i += MR) {
+            int_t mr = std::min((int_t)MR, m-i);
+            gemm_scatter_tile<MR,NR>(mr,n-n_full,k,&A[i*lda],lda,&Bt[n_full],ldb,C,&row_offset[i],&col_offset[n_full]);
+          }
+        }
+      }
+#endif
+
+    //Kernels specialized for narrow supernodes: the supernode width W is a template
+    //parameter so that the loops over it are fully unrolled. They follow the
+    //column major conventions of the BLAS calls they replace in blockCell_t.
+    static const int narrow_max_width = 16;
+
+    //widths up to which the narrow kernels are used instead of BLAS / LAPACK, 0 disables them.
+    //Each matrix has its own, they are passed to the cell kernels.
+    struct narrow_limits_t {
+      int potrf;
+      int trsm;
+      int update;
+    };
+
+    //calls K<w>::run(args...) if 1 <= w <= narrow_max_width, returns false otherwise
+    template <template <int> class K, typename... Args>
+      inline bool dispatch_width( int w, Args &&... args ) {
+        switch ( w ) {
+          case 1: K<1>::run(std::forward<Args>(args)...); return true;
+          case 2: K<2>::run(std::forward<Args>(args)...); return true;
+          case 3: K<3>::run(std::forward<Args>(args)...); return true;
+          case 4: K<4>::run(std::forward<Args>(args)...); return true;
+          case 5: K<5>::run(std::forward<Args>(args)...); return true;
+          case 6: K<6>::run(std::forward<Args>(args)...); return true;
+          case 7: K<7>::run(std::forward<Args>(args)...); return true;
+          case 8: K<8>::run(std::forward<Args>(args)...); return true;
+          case 9: K<9>::run(std::forward<Args>(args)...); return true;
+          case 10: K<10>::run(std::forward<Args>(args)...); return true;
+          case 11: K<11>::run(std::forward<Args>(args)...); return true;
+          case 12: K<12>::run(std::forward<Args>(args)...); return true;
+          case 13: K<13>::run(std::forward<Args>(args)...); return true;
+          case 14: K<14>::run(std::forward<Args>(args)...); return true;
+          case 15: K<15>::run(std::forward<Args>(args)...); return true;
+          case 16: K<16>::run(std::forward<Args>(args)...); return true;
+          default: return false;
+        }
+      }
+
+    //Potrf('U',W,A,W): A = U^T U, U(i,j) is stored in A[i+j*W].
+    //Scalar: it runs once per supernode on at most 16 x 16 entries.
+    //info is the 1-based column of the first non positive pivot, 0 on success
+    template <int W>
+      struct potrf_narrow_k {
+        template <typename T>
+          static void run( T * A, int & info ) {
+            info = 0;
+            for (int j = 0; j < W; ++j) {
+              T * aj = &A[j*W];
+              for (int i = 0; i < j; ++i) {
+                const T * ai = &A[i*W];
+                T s = aj[i];
+                for (int l = 0; l < i; ++l) { s -= ai[l]*aj[l]; }
+                aj[i] = s / ai[i];
+              }
+              T d = aj[j];
+              for (int l = 0; l < j; ++l) { d -= aj[l]*aj[l]; }
+              if ( !(d > T(0)) ) { info = j+1; return; }
+              aj[j] = std::sqrt(d);
+            }
+          }
+      };
+
+    //forward substitution of the nrows rows of B, one row at a time
+    template <int W, typename T>
+      inline void trsm_rows_narrow( int64_t nrows, const T * U, const T * inv_diag, T * B ) {
+        for (int64_t r = 0; r < nrows; ++r) {
+          T x[W];
+          const T * b = &B[r*W];
+          for (int i = 0; i < W; ++i) {
+            T s = b[i];
+            const T * ui = &U[i*W];
+            for (int l = 0; l < i; ++l) { s -= ui[l]*x[l]; }
+            x[i] = s * inv_diag[i];
+          }
+          for (int i = 0; i < W; ++i) { B[r*W+i] = x[i]; }
+        }
+      }
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+    //the rows are solved simd::width at a time: a block of rows is transposed so
+    //that each register holds the same entry of all of them
+    template <int W>
+      inline void trsm_rows_narrow( int64_t nrows, const double * U, const double * inv_diag, double * B ) {
+        using simd = simd_double;
+        using reg_t = simd::reg_t;
+        const int V = simd::width;
+        int64_t r = 0;
+        for (; r + V <= nrows; r += V) {
+          double bt[W][V];
+          for (int v = 0; v < V; ++v) {
+            for (int i = 0; i < W; ++i) { bt[i][v] = B[(r+v)*W+i]; }
+          }
+          reg_t x[W];
+          for (int i = 0; i < W; ++i) {
+            reg_t s = simd::loadu(bt[i]);
+            for (int l = 0; l < i; ++l) { s = simd::fmadd(simd::set1(-U[i*W+l]),x[l],s); }
+            x[i] = simd::fmadd(s,simd::set1(inv_diag[i]),simd::zero());
+          }
+          for (int i = 0; i < W; ++i) { simd::storeu(bt[i],x[i]); }
+          for (int v = 0; v < V; ++v) {
+            for (int i = 0; i < W; ++i) { B[(r+v)*W+i] = bt[i][v]; }
+          }
+        }
+        trsm_rows_narrow<W,double>(nrows-r,U,inv_diag,&B[r*W]);
+      }
+#endif
+
+    //Trsm('L','U','T','N',W,nrows,1,U,W,B,W): solves U^T x = b for every row b of B
+    template <int W>
+      struct trsm_narrow_k {
+        template <typename T>
+          static void run( int64_t nrows, const T * U, T * B ) {
+            T inv_diag[W];
+            for (int i = 0; i < W; ++i) { inv_diag[i] = T(1) / U[i*W+i]; }
+            trsm_rows_narrow<W>(nrows,U,inv_diag,B);
+          }
+      };
+
+    //c[j] = beta*c[j] - sum_l f[l]*Pt[l*ldp+j] for j < n, c is not read if beta is 0
+    template <int W, typename T>
+      inline void update_row_narrow( int64_t n, const T * f, const T * Pt, int64_t ldp, T beta, T * c ) {
+        for (int64_t j = 0; j < n; ++j) {
+          T acc = T(0);
+          for (int l = 0; l < W; ++l) { acc += f[l]*Pt[l*ldp+j]; }
+          c[j] = (beta == T(0) ? T(0) : beta*c[j]) - acc;
+        }
+      }
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+    template <int W>
+      inline void update_row_narrow( int64_t n, const double * f, const double * Pt, int64_t ldp, double beta, double * c ) {
+        using simd = simd_double;
+        using reg_t = simd::reg_t;
+        const int V = simd::width;
+        reg_t a[W];
+        for (int l = 0; l < W; ++l) { a[l] = simd::set1(f[l]); }
+        reg_t vbeta = simd::set1(beta);
+        int64_t j = 0;
+        for (; j + V <= n; j += V) {
+          reg_t acc = simd::zero();
+          for (int l = 0; l < W; ++l) { acc = simd::fmadd(a[l],simd::loadu(&Pt[l*ldp+j]),acc); }
+          reg_t cj = beta == 0.0 ? simd::zero() : simd::fmadd(vbeta,simd::loadu(&c[j]),simd::zero());
+          simd::storeu(&c[j],simd::sub(cj,acc));
+        }
+        for (; j < n; ++j) {
+          double acc = 0.0;
+          for (int l = 0; l < W; ++l) { acc += f[l]*Pt[l*ldp+j]; }
+          c[j] = (beta == 0.0 ? 0.0 : beta*c[j]) - acc;
+        }
+      }
+#endif
+
+    //Gemm('T','N',n,m,W,-1,P,W,F,W,beta,C,ldc) with the pivot P packed as Pt (W x n,
+    //see pack_transpose): C[j+r*ldc] = beta*C[j+r*ldc] - sum_l F[l+r*W]*P[l+j*W].
+    //With upper, only j <= r is computed, as Syrk('U','T',n,W,-1,P,W,beta,C,ldc) when F is P.
+    template <int W>
+      struct update_narrow_k {
+        template <typename T>
+          static void run( int64_t n, int64_t m, const T * Pt, const T * F, T beta, T * C, int64_t ldc, bool upper ) {
+            for (int64_t r = 0; r < m; ++r) {
+              int64_t nj = upper ? std::min(n,r+1) : n;
+              update_row_narrow<W>(nj,&F[r*W],Pt,n,beta,&C[r*ldc]);
+            }
+          }
+      };
+
+    //the narrow kernels only handle real types, they return false if the width is not handled
+    template <typename T>
+      inline typename std::enable_if<std::is_floating_point<T>::value,bool>::type
+      potrf_narrow( int w, T * A, int & info ) { return dispatch_width<potrf_narrow_k>(w,A,info); }
+    template <typename T>
+      inline typename std::enable_if<!std::is_floating_point<T>::value,bool>::type
+      potrf_narrow( int, T *, int & ) { return false; }
+
+    template <typename T>
+      inline typename std::enable_if<std::is_floating_point<T>::value,bool>::type
+      trsm_narrow( int w, int64_t nrows, const T * U, T * B ) { return dispatch_width<trsm_narrow_k>(w,nrows,U,B); }
+    template <typename T>
+      inline typename std::enable_if<!std::is_floating_point<T>::value,bool>::type
+      trsm_narrow( int, int64_t, const T *, T * ) { return false; }
+
+    template <typename T>
+      inline typename std::enable_if<std::is_floating_point<T>::value,bool>::type
+      update_narrow( int w, int64_t n, int64_t m, const T * Pt, const T * F, T beta, T * C, int64_t ldc, bool upper ) {
+        return dispatch_width<update_narrow_k>(w,n,m,Pt,F,beta,C,ldc,upper);
+      }
+    template <typename T>
+      inline typename std::enable_if<!std::is_floating_point<T>::value,bool>::type
+      update_narrow( int, int64_t, int64_t, const T *, const T *, T, T *, int64_t, bool ) { return false; }
+
+    //Times the narrow kernels against BLAS / LAPACK for every width and returns, for
+    //each kernel, the largest width up to which the narrow kernel is always faster.
+    //The timings are written to os if it is not null.
+    template <typename T>
+      inline narrow_limits_t calibrate_narrow( std::ostream * os = nullptr, int reps = 20 ) {
+        narrow_limits_t limits = {0,0,0};
+        if ( !std::is_floating_point<T>::value ) return limits;
+        //rows of the trsm and of the updates, typical of a leaf level cell
+        const int64_t nrows = 64;
+        const int64_t ncols = 32;
+        bool potrf_wins = true, trsm_wins = true, update_wins = true;
+        auto time_us = [reps]( const std::function<void()> & f ) {
+          double best = -1.0;
+          for (int trial = 0; trial < 3; trial++) {
+            auto t1 = std::chrono::steady_clock::now();
+            for (int r = 0; r < reps; r++) { f(); }
+            auto t2 = std::chrono::steady_clock::now();
+            double us = std::chrono::duration<double,std::micro>(t2-t1).count()/reps;
+            if ( best < 0.0 || us < best ) best = us;
+          }
+          return best;
+        };
+        if ( os != nullptr ) { (*os)<<"width potrf(blas/narrow us) trsm(blas/narrow us) update(blas/narrow us)"<<std::endl; }
+        for (int w = 1; w <= narrow_max_width; w++) {
+          //diagonally dominant, hence positive definite
+          std::vector<T> spd(w*w), diag(w*w), rhs(nrows*w), B(nrows*w), F(nrows*w), P(ncols*w), Pt(ncols*w), C(nrows*ncols);
+          for (int i = 0; i < w; i++) {
+            for (int j = 0; j < w; j++) { spd[i+j*w] = i == j ? T(2*w) : T(1)/T(1+i+j); }
+          }
+          for (int64_t idx = 0; idx < nrows*w; idx++) { rhs[idx] = T(1)/T(1+idx%7); F[idx] = T(1)/T(1+idx%5); }
+          for (int64_t idx = 0; idx < ncols*w; idx++) { P[idx] = T(1)/T(1+idx%3); }
+          int info = 0;
+          diag = spd;
+          lapack::Potrf('U',w,diag.data(),w);
+
+          double potrf_blas = time_us([&]() { std::copy(spd.begin(),spd.end(),diag.begin()); lapack::Potrf('U',w,diag.data(),w); });
+          double potrf_fast = time_us([&]() { std::copy(spd.begin(),spd.end(),diag.begin()); potrf_narrow(w,diag.data(),info); });
+          double trsm_blas = time_us([&]() { std::copy(rhs.begin(),rhs.end(),B.begin());
+              blas::Trsm('L','U','T','N',w,nrows,T(1),diag.data(),w,B.data(),w); });
+          double trsm_fast = time_us([&]() { std::copy(rhs.begin(),rhs.end(),B.begin()); trsm_narrow(w,nrows,diag.data(),B.data()); });
+          double update_blas = time_us([&]() {
+              blas::Gemm('T','N',ncols,nrows,w,T(-1),P.data(),w,F.data(),w,T(0),C.data(),ncols); });
+          double update_fast = time_us([&]() {
+              pack_transpose(ncols,(int64_t)w,P.data(),(int64_t)w,Pt.data());
+              update_narrow(w,ncols,nrows,Pt.data(),F.data(),T(0),C.data(),ncols,false); });
+
+          potrf_wins = potrf_wins && potrf_fast < potrf_blas;
+          trsm_wins = trsm_wins && trsm_fast < trsm_blas;
+          update_wins = update_wins && update_fast < update_blas;
+          if ( potrf_wins ) limits.potrf = w;
+          if ( trsm_wins ) limits.trsm = w;
+          if ( update_wins ) limits.update = w;
+          if ( os != nullptr ) {
+            (*os)<<w<<" "<<potrf_blas<<"/"<<potrf_fast<<" "<<trsm_blas<<"/"<<trsm_fast<<" "<<update_blas<<"/"<<update_fast<<std::endl;
+          }
+        }
+        return limits;
+      }
+
+    //Shares the row tiles of a large kernel with the threads that have nothing
+    //else to do. The 2D work stealing pool registers itself for its workers,
+    //other threads have no executor and run their kernels in one piece.
+    class tile_executor_t {
+      public:
+        //a tile is never smaller than this many rows
+        static const int64_t min_tile_rows = 32;
+
+        tile_executor_t():min_flops(0.0) {}
+        virtual ~tile_executor_t() {}
+
+        //runs body(0..ntiles-1) with the help of the idle threads,
+        //returns false without running anything if no thread is idle
+        virtual bool parallel_for( int ntiles, const std::function<void(int)> & body ) = 0;
+        virtual int concurrency() const = 0;
+
+        //executor of the calling thread, nullptr if it cannot share its work
+        static tile_executor_t *& current() {
+          static thread_local tile_executor_t * executor = nullptr;
+          return executor;
+        }
+
+        //kernels of less flops are never tiled, 0 disables the tiling
+        double min_flops;
+    };
+
+    //runs fn(first,count) on row tiles covering [0,nrows), in parallel when
+    //the kernel is worth flops and some threads are idle
+    template <typename F>
+      inline void run_tiled( int64_t nrows, double flops, F && fn ) {
+        auto executor = tile_executor_t::current();
+        if ( executor != nullptr && executor->min_flops > 0.0 && flops >= executor->min_flops
+            && nrows >= 2*tile_executor_t::min_tile_rows ) {
+          int ntiles = (int)std::min<int64_t>(nrows/tile_executor_t::min_tile_rows,2*executor->concurrency());
+          if ( executor->parallel_for(ntiles,[&fn,nrows,ntiles](int tile) {
+                int64_t first = nrows*tile/ntiles;
+                int64_t last = nrows*(tile+1)/ntiles;
+                fn(first,last-first);
+                }) ) {
+            return;
+          }
+        }
+        fn((int64_t)0,nrows);
+      }
+
+  } // namespace kernels
+} // namespace symPACK
+
+#endif // _SYMPACK_UPDATE_KERNELS_HPP_